@@ -224,6 +224,16 @@ uint64_t memory_usage() {
 // Get current process's name
 const std::string &process_name() { return g_inner_sys_info().proc_name; }
 
+// Get the cpu list of given NUMA node
+std::vector<int> numa_node_cpus(int node) {
+  std::vector<int> _cpus;
+  // No NUMA info, all cpus belong to node 0
+  if (node == 0) {
+    for (size_t i = 0; i < cpu_count(); ++i) _cpus.push_back((int)i);
+  }
+  return _cpus;
+}
+
 } // namespace peco
 
 #endif
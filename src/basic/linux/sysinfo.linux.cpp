@@ -238,6 +238,31 @@ uint64_t memory_usage() {
 // Get current process's name
 const std::string &process_name() { return g_inner_sys_info().proc_name; }
 
+// Get the cpu list of given NUMA node
+std::vector<int> numa_node_cpus(int node) {
+  std::vector<int> _cpus;
+  std::ifstream _fnode("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  if (!_fnode) {
+    // No NUMA info, all cpus belong to node 0
+    if (node == 0) {
+      for (size_t i = 0; i < cpu_count(); ++i) _cpus.push_back((int)i);
+    }
+    return _cpus;
+  }
+  std::string _line;
+  std::getline(_fnode, _line);
+  _fnode.close();
+  // format: 0-3,8-11
+  for (const auto& _range : peco::split(_line, ",\n")) {
+    auto _bounds = peco::split(_range, "-");
+    if (_bounds.size() == 0 || !is_number(_bounds[0])) continue;
+    int _begin = std::stoi(_bounds[0]);
+    int _end = (_bounds.size() > 1 && is_number(_bounds[1])) ? std::stoi(_bounds[1]) : _begin;
+    for (int i = _begin; i <= _end; ++i) _cpus.push_back(i);
+  }
+  return _cpus;
+}
+
 } // namespace peco
 
 #endif
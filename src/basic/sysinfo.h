@@ -60,6 +60,9 @@ uint64_t memory_usage();
 // Get current process's name
 const std::string & process_name();
 
+// Get the cpu list of given NUMA node
+std::vector< int > numa_node_cpus(int node);
+
 } // namespace peco
 
 #endif
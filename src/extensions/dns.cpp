@@ -382,6 +382,7 @@ void dns_resolver::set_dns_server(const std::string& dns_server) {
 */
 std::list<dns_a_record> dns_resolver::resolv(const std::string& domain) {
   if (!dns_server_) return {};
+  if (task::this_task().is_deadline_exceeded()) return {};
   return resolv_by_udp(dns_server_, domain);
 }
 std::list<dns_a_record> dns_resolver::operator()(const std::string& domain) {
@@ -403,6 +404,9 @@ std::list<dns_a_record> resolv_by_udp(const peer_t& dns_server, const std::strin
     return {};
   }
   auto r = uc->read();
+  if (r.status != kNetOpStatusOK || r.data.size() < sizeof(dns_packet_header)) {
+    return {};
+  }
   dns_packet rpkt;
   rpkt.packet = &r.data[0];
   rpkt.length = r.data.size();
@@ -432,6 +436,9 @@ std::list<dns_a_record> resolv_by_tcp(const peer_t& dns_server, const std::strin
     return {};
   }
   auto r = tc->read();
+  if (r.status != kNetOpStatusOK || r.data.size() < sizeof(uint16_t) + sizeof(dns_packet_header)) {
+    return {};
+  }
   dns_packet rpkt;
   rpkt.packet = &r.data[0];
   rpkt.length = r.data.size();
@@ -541,12 +541,20 @@ bool redis_connector::connection_test() {
 */
 redis_result_t redis_connector::query(redis_command&& cmd) {
   redis_result_t r = redis_result::no_result;
+  auto this_task = task::this_task();
+  if (this_task.is_deadline_exceeded()) return r;
+  auto deadline = this_task.deadline();
   auto self = this->shared_from_this();
-  cmd_queue_->sync([cmd = std::move(cmd), &r, self]() {
+  cmd_queue_->sync([cmd = std::move(cmd), &r, self, deadline]() {
+    // the query runs in the queue's task, carry the caller's deadline
+    auto queue_task = task::this_task();
+    auto queue_deadline = queue_task.deadline();
+    queue_task.set_deadline(deadline);
     // do inner query
     if (self->do_query_job_(std::move(cmd))) {
       r = std::move(self->last_result_);
     }
+    queue_task.set_deadline(queue_deadline);
   });
   return r;
 }
@@ -635,8 +643,16 @@ bool redis_connector::do_query_job_(const redis_command& cmd) {
   std::string sbuf;
   do {
     auto r = conn_->read();
-    // No data, maybe subscribe
-    if (r.status == kNetOpStatusTimedout) continue;
+    if (r.status == kNetOpStatusTimedout) {
+      // Out of the deadline, the rest of the response is still on the
+      // wire, drop the connection
+      if (task::this_task().is_deadline_exceeded()) {
+        conn_ = nullptr;
+        return false;
+      }
+      // No data, maybe subscribe
+      continue;
+    }
     if (r.status == kNetOpStatusFailed) {
       // broken connection
       conn_ = nullptr;
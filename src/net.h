@@ -38,6 +38,7 @@ SOFTWARE.
 #include "net/iprange.h"
 #include "net/peer.h"
 #include "net/utils.h"
+#include "net/buffer.h"
 #include "net/adapter.h"
 #include "net/bind.h"
 #include "net/connect.h"
@@ -45,6 +46,9 @@ SOFTWARE.
 #include "net/udp.h"
 #include "net/uds.h"
 #include "net/dup.h"
+#include "net/writer.h"
+#include "net/relay.h"
+#include "net/shard.h"
 
 #endif
 
@@ -31,6 +31,7 @@ SOFTWARE.
 
 #include "net/adapter.h"
 #include "task.h"
+#include "basic/logs.h"
 
 namespace peco {
 
@@ -62,6 +63,13 @@ inet_incoming::operator bool() const {
   return (status == kNetOpStatusOK && data.size() > 0);
 }
 
+/**
+ * @brief Bool cast
+*/
+inet_view_incoming::operator bool() const {
+  return (status == kNetOpStatusOK && data.size() > 0);
+}
+
 /**
  * @brief Move is allowed
 */
@@ -90,6 +98,13 @@ bool inet_adapter::bind(inet_adapter::slot_bind_t bind_slot) {
   return bind_slot(fd_);
 }
 
+/**
+ * @brief Get the socket fd, for syscalls the adapter does not wrap
+*/
+SOCKET_T inet_adapter::native_fd() const {
+  return fd_;
+}
+
 /**
  * @brief The default c'stor is not allowed to be invoked outside the class
 */
@@ -125,6 +140,14 @@ bool connector_adapter::set_buffer_size(uint32_t rmem, uint32_t wmem) {
   return net_utils::buffersize(fd_, rmem, wmem);
 }
 
+/**
+ * @brief Cork the socket, only works for tcp
+*/
+bool connector_adapter::set_cork(bool cork) {
+  if (INVALIDATE_SOCKET == fd_) return false;
+  return net_utils::cork(fd_, cork);
+}
+
 /**
  * @brief Connect to peer
 */
@@ -141,12 +164,8 @@ bool connector_adapter::connect(connector_adapter::slot_connect_t connect_slot)
 inet_incoming connector_adapter::read(duration_t timedout, size_t bufsize) {
   if (SOCKET_NOT_VALIDATE(fd_)) return inet_incoming(kNetOpStatusFailed, "");
   if (!is_connected()) return inet_incoming(kNetOpStatusFailed, "");
-  if (!net_utils::has_data_pending(fd_)) {
-    task::this_task().wait_fd_for_event(fd_, kEventTypeRead, timedout);
-    auto sig = task::this_task().signal();
-    if (sig == kWaitingSignalNothing) return inet_incoming(kNetOpStatusTimedout, "");
-    if (sig == kWaitingSignalBroken) return inet_incoming(kNetOpStatusFailed, "");
-  }
+  auto status = this->wait_for_reading_(timedout);
+  if (status != kNetOpStatusOK) return inet_incoming(status, "");
   std::string buffer;
   bool ret = net_utils::read(buffer, fd_, std::bind(
     ::recv, 
@@ -164,36 +183,85 @@ inet_incoming connector_adapter::read(duration_t timedout, size_t bufsize) {
 }
 
 /**
- * @brief Write data to peer socket
+ * @brief Read data from peer socket into a pooled slab, no allocation
+ * and no memset, the slab is recycled when the view is released
 */
-bool connector_adapter::write(const char* data, size_t length, duration_t timedout) {
-  if (SOCKET_NOT_VALIDATE(fd_)) return false;
-  if (!is_connected()) return false;
-  if ( length == 0 ) return true;
-  size_t sent = 0;
+inet_view_incoming connector_adapter::read_view(duration_t timedout) {
+  inet_view_incoming incoming{kNetOpStatusFailed, net_view()};
+  if (SOCKET_NOT_VALIDATE(fd_)) return incoming;
+  if (!is_connected()) return incoming;
+  net_view v = net_view::fetch();
+  size_t received = 0;
+  incoming.status = this->read_into(v.data(), v.size(), received, timedout);
+  if (incoming.status == kNetOpStatusOK) {
+    v.shrink(received);
+    incoming.data = std::move(v);
+  }
+  return incoming;
+}
+
+/**
+ * @brief Read data from peer socket into the caller's buffer,
+ * <received> is the size of data been read, kNetOpStatusOK always comes
+ * with data, kNetOpStatusTimedout if nothing arrives in time
+*/
+NetOpStatus connector_adapter::read_into(char* buffer, size_t length, size_t& received, duration_t timedout) {
+  received = 0;
+  if (SOCKET_NOT_VALIDATE(fd_)) return kNetOpStatusFailed;
+  if (!is_connected()) return kNetOpStatusFailed;
+  auto end_time = TASK_TIME_NOW() + timedout;
+  auto status = this->wait_for_reading_(timedout);
+  if (status != kNetOpStatusOK) return status;
   do {
-    // Single Package max size is 4k
-    int single_pkg = std::min((size_t)(length - sent), (size_t)(4 * 1024));
-    int _ret = net_utils::write(
-      fd_,
-      data + sent, single_pkg,
-      std::bind(::send,
-          std::placeholders::_1,
-          std::placeholders::_2,
-          std::placeholders::_3,
-          0 | SO_NETWORK_NOSIGNAL)
-    );
-    if ( _ret == -1 ) return false;
-    sent += (size_t)_ret;
-
-    if (sent < length) {
-      task::this_task().wait_fd_for_event(fd_, kEventTypeWrite, timedout);
-      auto sig = task::this_task().signal();
-      if (sig == kWaitingSignalBroken) break;
-      if (sig == kWaitingSignalNothing) break;
+    auto ret = ::recv(fd_, buffer, length, 0 | SO_NETWORK_NOSIGNAL);
+    if (ret > 0) {
+      received = (size_t)ret;
+      return kNetOpStatusOK;
+    }
+    if (ret == 0) {
+      // Peer Close
+      return kNetOpStatusFailed;
     }
-  } while (sent < length);
-  return sent == length;
+    if (errno == EINTR) continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      // Woken up with nothing to read, wait for the rest of the timeout
+      auto now = TASK_TIME_NOW();
+      if (now >= end_time) return kNetOpStatusTimedout;
+      status = this->wait_for_reading_(end_time - now);
+      if (status != kNetOpStatusOK) return status;
+      continue;
+    }
+    log::error << "Error: Failed to receive data on socket(" << fd_ << "), "
+      << ::strerror(errno) << std::endl;
+    return kNetOpStatusFailed;
+  } while (true);
+}
+
+/**
+ * @brief Wait until the socket is readable
+*/
+NetOpStatus connector_adapter::wait_for_reading_(duration_t timedout) {
+  // The request has already missed its deadline
+  if (task::this_task().is_deadline_exceeded()) return kNetOpStatusTimedout;
+  if (net_utils::has_data_pending(fd_)) return kNetOpStatusOK;
+  task::this_task().wait_fd_for_event(fd_, kEventTypeRead, timedout);
+  auto sig = task::this_task().signal();
+  if (sig == kWaitingSignalNothing) return kNetOpStatusTimedout;
+  if (sig == kWaitingSignalBroken) {
+    // The peer hung up, but the last data may still be in the buffer
+    if (task::this_task().is_cancelled() || !net_utils::has_data_pending(fd_)) {
+      return kNetOpStatusFailed;
+    }
+  }
+  return kNetOpStatusOK;
+}
+
+/**
+ * @brief Write data to peer socket
+*/
+bool connector_adapter::write(const char* data, size_t length, duration_t timedout) {
+  net_span span{data, length};
+  return this->write(&span, 1, timedout);
 }
 bool connector_adapter::write(std::string&& data, duration_t timedout) {
   return this->write(data.c_str(), data.size(), timedout);
@@ -201,6 +269,95 @@ bool connector_adapter::write(std::string&& data, duration_t timedout) {
 bool connector_adapter::write(const std::string& data, duration_t timedout) {
   return this->write(data.c_str(), data.size(), timedout);
 }
+
+/**
+ * @brief Write all spans to peer socket in order, with as few syscalls
+ * as the kernel allows, no need to concatenate them first
+*/
+bool connector_adapter::write(const net_span* spans, size_t count, duration_t timedout) {
+  if (SOCKET_NOT_VALIDATE(fd_)) return false;
+  if (!is_connected()) return false;
+  // The request has already missed its deadline
+  if (task::this_task().is_deadline_exceeded()) return false;
+  // The first unfinished span, and the sent size of it
+  size_t index = 0;
+  size_t offset = 0;
+  while (true) {
+    while (index < count && offset >= spans[index].length) {
+      ++index;
+      offset = 0;
+    }
+    if (index == count) return true;
+#if PECO_TARGET_WIN
+    auto ret = ::send(fd_, spans[index].data + offset,
+      (int)(spans[index].length - offset), 0 | SO_NETWORK_NOSIGNAL);
+#else
+    struct iovec iov[PECO_NET_IOV_BATCH];
+    size_t iov_count = 0;
+    for (size_t i = index; i < count && iov_count < PECO_NET_IOV_BATCH; ++i) {
+      size_t skip = (i == index ? offset : 0);
+      if (spans[i].length == skip) continue;
+      iov[iov_count].iov_base = (void *)(spans[i].data + skip);
+      iov[iov_count].iov_len = spans[i].length - skip;
+      ++iov_count;
+    }
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+    auto ret = ::sendmsg(fd_, &msg, 0 | SO_NETWORK_NOSIGNAL);
+#endif
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+        log::warning << "Failed to send data on socket(" << fd_ << "), "
+          << ::strerror(errno) << std::endl;
+        return false;
+      }
+      // Only park when the socket buffer is full
+      task::this_task().wait_fd_for_event(fd_, kEventTypeWrite, timedout);
+      if (task::this_task().signal() != kWaitingSignalReceived) return false;
+      continue;
+    }
+    // Move forward
+    size_t sent = (size_t)ret;
+    while (sent > 0) {
+      size_t left = spans[index].length - offset;
+      if (sent < left) {
+        offset += sent;
+        break;
+      }
+      sent -= left;
+      ++index;
+      offset = 0;
+    }
+  }
+}
+bool connector_adapter::write(std::initializer_list<net_span> spans, duration_t timedout) {
+  return this->write(spans.begin(), spans.size(), timedout);
+}
+
+/**
+ * @brief Send as much data as the socket buffer accepts without waiting,
+ * return the size been sent, -1 if the socket is broken
+*/
+int64_t connector_adapter::try_write(const char* data, size_t length) {
+  if (SOCKET_NOT_VALIDATE(fd_)) return -1;
+  if (!is_connected()) return -1;
+  size_t sent = 0;
+  while (sent < length) {
+    auto ret = ::send(fd_, data + sent, length - sent, 0 | SO_NETWORK_NOSIGNAL);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) break;
+      log::warning << "Failed to send data on socket(" << fd_ << "), "
+        << ::strerror(errno) << std::endl;
+      return -1;
+    }
+    sent += (size_t)ret;
+  }
+  return (int64_t)sent;
+}
 /**
  * @brief Tell if the connector is already connected to peer
 */
@@ -35,6 +35,7 @@ SOFTWARE.
 #define PECO_NET_ADAPTER_H__
 
 #include "net/utils.h"
+#include "net/buffer.h"
 #include "task/taskdef.h"
 
 namespace peco {
@@ -85,6 +86,22 @@ struct inet_incoming {
   operator bool() const;
 };
 
+struct inet_view_incoming {
+  /**
+   * @brief The status of the reading operation
+  */
+  NetOpStatus status;
+  /**
+   * @brief The data received, in a pooled slab
+  */
+  net_view data;
+
+  /**
+   * @brief Bool cast
+  */
+  operator bool() const;
+};
+
 class inet_adapter {
 public:
   typedef std::function<bool(SOCKET_T)>   slot_bind_t;
@@ -111,6 +128,11 @@ public:
    * different bind slot
   */
   bool bind(slot_bind_t bind_slot);
+
+  /**
+   * @brief Get the socket fd, for syscalls the adapter does not wrap
+  */
+  SOCKET_T native_fd() const;
 protected:
   /**
    * @brief The default c'stor is not allowed to be invoked outside the class
@@ -149,6 +171,11 @@ public:
   */
   bool set_buffer_size(uint32_t rmem, uint32_t wmem);
 
+  /**
+   * @brief Cork the socket, only works for tcp
+  */
+  bool set_cork(bool cork);
+
   /**
    * @brief Connect to peer
   */
@@ -159,6 +186,19 @@ public:
   */
   virtual inet_incoming read(duration_t timedout = PECO_TIME_S(10), size_t bufsize = 4096);
 
+  /**
+   * @brief Read data from peer socket into a pooled slab, no allocation
+   * and no memset, the slab is recycled when the view is released
+  */
+  inet_view_incoming read_view(duration_t timedout = PECO_TIME_S(10));
+
+  /**
+   * @brief Read data from peer socket into the caller's buffer,
+   * <received> is the size of data been read, kNetOpStatusOK always comes
+   * with data, kNetOpStatusTimedout if nothing arrives in time
+  */
+  NetOpStatus read_into(char* buffer, size_t length, size_t& received, duration_t timedout = PECO_TIME_S(10));
+
   /**
    * @brief Write data to peer socket
   */
@@ -166,6 +206,19 @@ public:
   bool write(std::string&& data, duration_t timedout = PECO_TIME_S(10));
   bool write(const std::string& data, duration_t timedout = PECO_TIME_S(10));
 
+  /**
+   * @brief Write all spans to peer socket in order, with as few syscalls
+   * as the kernel allows, no need to concatenate them first
+  */
+  bool write(const net_span* spans, size_t count, duration_t timedout = PECO_TIME_S(10));
+  bool write(std::initializer_list<net_span> spans, duration_t timedout = PECO_TIME_S(10));
+
+  /**
+   * @brief Send as much data as the socket buffer accepts without waiting,
+   * return the size been sent, -1 if the socket is broken
+  */
+  int64_t try_write(const char* data, size_t length);
+
   /**
    * @brief Tell if the connector is already connected to peer
   */
@@ -178,6 +231,11 @@ protected:
    * @brief Reset connect status
   */
   void reset_connect_();
+
+  /**
+   * @brief Wait until the socket is readable
+  */
+  NetOpStatus wait_for_reading_(duration_t timedout);
 };
 
 class listener_adapter : public inet_adapter {
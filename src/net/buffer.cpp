@@ -0,0 +1,209 @@
+/*
+    buffer.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "net/buffer.h"
+
+#include <vector>
+
+namespace peco {
+
+struct net_slab {
+  size_t    refcount;
+  char      data[PECO_NET_SLAB_SIZE];
+};
+
+class __slab_pool {
+public:
+  net_slab* fetch() {
+    net_slab* slab = nullptr;
+    if (cache_list_.size() > 0) {
+      slab = cache_list_.back();
+      cache_list_.pop_back();
+    } else {
+      slab = new net_slab;
+    }
+    slab->refcount = 1;
+    return slab;
+  }
+  void release(net_slab* slab) {
+    if (cache_list_.size() >= PECO_NET_SLAB_CACHE_COUNT) {
+      delete slab;
+    } else {
+      cache_list_.push_back(slab);
+    }
+  }
+  size_t free_count() const {
+    return cache_list_.size();
+  }
+  ~__slab_pool() {
+    for (auto slab : cache_list_) {
+      delete slab;
+    }
+  }
+
+  static __slab_pool& instance() {
+    thread_local static __slab_pool s_pool;
+    return s_pool;
+  }
+protected:
+  std::vector<net_slab*> cache_list_;
+};
+
+/**
+ * @brief Empty view
+*/
+net_view::net_view() { }
+
+/**
+ * @brief Copy & Move, only the reference count changes
+*/
+net_view::net_view(const net_view& other)
+  : slab_(other.slab_), data_(other.data_), size_(other.size_) {
+  if (slab_ != nullptr) ++slab_->refcount;
+}
+net_view::net_view(net_view&& other)
+  : slab_(other.slab_), data_(other.data_), size_(other.size_) {
+  other.slab_ = nullptr;
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+net_view& net_view::operator = (const net_view& other) {
+  if (this == &other) return *this;
+  if (other.slab_ != nullptr) ++other.slab_->refcount;
+  this->release_();
+  slab_ = other.slab_;
+  data_ = other.data_;
+  size_ = other.size_;
+  return *this;
+}
+net_view& net_view::operator = (net_view&& other) {
+  if (this == &other) return *this;
+  this->release_();
+  slab_ = other.slab_;
+  data_ = other.data_;
+  size_ = other.size_;
+  other.slab_ = nullptr;
+  other.data_ = nullptr;
+  other.size_ = 0;
+  return *this;
+}
+
+/**
+ * @brief Release the reference of the slab
+*/
+net_view::~net_view() {
+  this->release_();
+}
+
+/**
+ * @brief Fetch a slab from current thread's pool, the whole slab is
+ * the view, shrink it after filling data
+*/
+net_view net_view::fetch() {
+  net_view v;
+  v.slab_ = __slab_pool::instance().fetch();
+  v.data_ = v.slab_->data;
+  v.size_ = PECO_NET_SLAB_SIZE;
+  return v;
+}
+
+/**
+ * @brief Get the free slab count of current thread's pool
+*/
+size_t net_view::free_count() {
+  return __slab_pool::instance().free_count();
+}
+
+/**
+ * @brief Data of the view
+*/
+const char* net_view::data() const {
+  return data_;
+}
+char* net_view::data() {
+  return data_;
+}
+
+/**
+ * @brief Size of the view
+*/
+size_t net_view::size() const {
+  return size_;
+}
+
+/**
+ * @brief Tell if the view is empty
+*/
+bool net_view::empty() const {
+  return size_ == 0;
+}
+
+/**
+ * @brief Shrink the view to the first <length> bytes
+*/
+void net_view::shrink(size_t length) {
+  size_ = std::min(size_, length);
+}
+
+/**
+ * @brief Get a part of the view, without copy
+*/
+net_view net_view::sub(size_t offset, size_t length) const {
+  net_view v(*this);
+  offset = std::min(offset, size_);
+  v.data_ += offset;
+  v.size_ = std::min(length, size_ - offset);
+  return v;
+}
+
+/**
+ * @brief Drop the reference, return the slab to the pool if it is the last one
+*/
+void net_view::release_() {
+  if (slab_ != nullptr && --slab_->refcount == 0) {
+    __slab_pool::instance().release(slab_);
+  }
+  slab_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+/**
+ * @brief Copy the data out
+*/
+std::string net_view::str() const {
+  if (size_ == 0) return std::string();
+  return std::string(data_, size_);
+}
+
+} // namespace peco
+
+// Push Chen
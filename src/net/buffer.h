@@ -0,0 +1,154 @@
+/*
+    buffer.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_NET_BUFFER_H__
+#define PECO_NET_BUFFER_H__
+
+#include "pecostd.h"
+
+namespace peco {
+
+#ifndef PECO_NET_SLAB_SIZE
+// Size of a pooled receive buffer
+#define PECO_NET_SLAB_SIZE          16384   // 16KB
+#endif
+
+#ifndef PECO_NET_SLAB_CACHE_COUNT
+// Max free slabs kept by each thread
+#define PECO_NET_SLAB_CACHE_COUNT   1024
+#endif
+
+#ifndef PECO_NET_IOV_BATCH
+// Max spans sent by one sendmsg call
+#define PECO_NET_IOV_BATCH          64
+#endif
+
+/**
+ * @brief A piece of data to be sent, not owned
+*/
+struct net_span {
+  const char*   data;
+  size_t        length;
+};
+
+/**
+ * @brief A refcounted receive buffer, recycled by the thread's slab pool
+*/
+struct net_slab;
+
+/**
+ * @brief A view of received data in a pooled slab, copying a view does
+ * not copy the data. The slab goes back to the pool when the last view
+ * is released. A view and its copies must stay in one thread.
+*/
+class net_view {
+public:
+  /**
+   * @brief Empty view
+  */
+  net_view();
+
+  /**
+   * @brief Copy & Move, only the reference count changes
+  */
+  net_view(const net_view& other);
+  net_view(net_view&& other);
+  net_view& operator = (const net_view& other);
+  net_view& operator = (net_view&& other);
+
+  /**
+   * @brief Release the reference of the slab
+  */
+  ~net_view();
+
+public:
+  /**
+   * @brief Fetch a slab from current thread's pool, the whole slab is
+   * the view, shrink it after filling data
+  */
+  static net_view fetch();
+
+  /**
+   * @brief Get the free slab count of current thread's pool
+  */
+  static size_t free_count();
+
+public:
+  /**
+   * @brief Data of the view
+  */
+  const char* data() const;
+  char* data();
+
+  /**
+   * @brief Size of the view
+  */
+  size_t size() const;
+
+  /**
+   * @brief Tell if the view is empty
+  */
+  bool empty() const;
+
+  /**
+   * @brief Shrink the view to the first <length> bytes
+  */
+  void shrink(size_t length);
+
+  /**
+   * @brief Get a part of the view, without copy
+  */
+  net_view sub(size_t offset, size_t length = (size_t)-1) const;
+
+  /**
+   * @brief Copy the data out
+  */
+  std::string str() const;
+
+protected:
+  /**
+   * @brief Drop the reference, return the slab to the pool if it is the last one
+  */
+  void release_();
+
+protected:
+  net_slab*     slab_ = nullptr;
+  char*         data_ = nullptr;
+  size_t        size_ = 0;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
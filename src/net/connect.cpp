@@ -68,6 +68,11 @@ tcp_connect& tcp_connect::operator =(tcp_connect&& other) {
 */
 bool tcp_connect::operator()(SOCKET_T fd) {
   if (!dest_addr_) return false;
+  if (task::this_task().is_deadline_exceeded()) {
+    log::warning << "Warning: deadline exceeded before connecting to " << dest_addr_
+      << " on tcp socket(" << fd << ")." << std::endl;
+    return false;
+  }
 
   struct sockaddr_in sock_addr = dest_addr_;
   if ( ::connect(fd, (struct sockaddr *)&sock_addr, sizeof(sock_addr)) == -1 ) {
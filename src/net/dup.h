@@ -36,41 +36,67 @@ SOFTWARE.
 
 #include "task.h"
 #include "utils.h"
+#include "relay.h"
 
 namespace peco {
 
+/**
+ * @brief Read & write relay for adapters which are not connectors
+*/
 template <typename _TyIncomingAdapter, typename _TyOutgoingAdapter>
-void dup(std::shared_ptr<_TyIncomingAdapter> i, std::shared_ptr<_TyOutgoingAdapter> o) {
-  auto i2o = loop::shared()->run([=]() {
+void __dup(std::shared_ptr<_TyIncomingAdapter> i, std::shared_ptr<_TyOutgoingAdapter> o, std::false_type) {
+  // Any direction stops, the other one will be cancelled
+  auto group = task_group::create(kGroupPolicyFirstResult);
+  group->run([=]() {
+    // The relay outlives the request which starts it
+    task::this_task().set_deadline(task_time_t::max());
     while(true) {
       auto d = i->read();
       if (d.status == kNetOpStatusFailed) {
         break;
       }
       if (d.status == kNetOpStatusTimedout) {
+        if (task::this_task().is_deadline_exceeded()) break;
         continue;
       }
       o->write(d.data);
     }
+    return true;
   });
-  auto o2i = loop::shared()->run([=](){
+  group->run([=]() {
+    // The relay outlives the request which starts it
+    task::this_task().set_deadline(task_time_t::max());
     while(true) {
       auto d = o->read();
       if (d.status == kNetOpStatusFailed) {
         break;
       }
       if (d.status == kNetOpStatusTimedout) {
+        if (task::this_task().is_deadline_exceeded()) break;
         continue;
       }
       i->write(d.data);
     }
+    return true;
   });
-  i2o.set_atexit([o2i]() {
-    task(o2i).cancel();
-  });
-  o2i.set_atexit([i2o]() {
-    task(i2o).cancel();
-  });
+}
+
+/**
+ * @brief Connectors are relayed by peco::relay, zero-copy when possible
+*/
+template <typename _TyIncomingAdapter, typename _TyOutgoingAdapter>
+void __dup(std::shared_ptr<_TyIncomingAdapter> i, std::shared_ptr<_TyOutgoingAdapter> o, std::true_type) {
+  ignore_result(relay(i, o));
+}
+
+/**
+ * @brief Relay all data between <i> and <o> in both directions
+*/
+template <typename _TyIncomingAdapter, typename _TyOutgoingAdapter>
+void dup(std::shared_ptr<_TyIncomingAdapter> i, std::shared_ptr<_TyOutgoingAdapter> o) {
+  __dup(i, o, std::integral_constant<bool,
+    std::is_base_of<connector_adapter, _TyIncomingAdapter>::value &&
+    std::is_base_of<connector_adapter, _TyOutgoingAdapter>::value>());
 }
 
 } // namespace peco
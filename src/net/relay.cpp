@@ -0,0 +1,262 @@
+/*
+    relay.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "net/relay.h"
+#include "task.h"
+#include "basic/logs.h"
+
+#if PECO_TARGET_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace peco {
+
+/**
+ * @brief Result of one relay direction
+*/
+enum RelayEnd {
+  kRelayEndClosed,
+  kRelayEndFailed
+};
+
+/**
+ * @brief One direction of a relay
+*/
+struct __relay_direction_t {
+  std::shared_ptr<connector_adapter>  i;
+  std::shared_ptr<connector_adapter>  o;
+  std::shared_ptr<relay_stats>        stats;
+  relay_options                       options;
+  uint64_t*                           counter;
+};
+
+/**
+ * @brief Average bytes per second of each direction over the relay's life
+*/
+static double __relay_rate(const relay_stats* stats, uint64_t bytes) {
+  auto end = (stats->end_time == task_time_t::max() ? TASK_TIME_NOW() : stats->end_time);
+  double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+    end - stats->start_time).count();
+  if (seconds <= 0) return 0;
+  return (double)bytes / seconds;
+}
+double relay_stats::in_to_out_rate() const {
+  return __relay_rate(this, in_to_out);
+}
+double relay_stats::out_to_in_rate() const {
+  return __relay_rate(this, out_to_in);
+}
+
+/**
+ * @brief Count the moved bytes
+*/
+static void __relay_moved(__relay_direction_t& d, size_t bytes) {
+  *d.counter += (uint64_t)bytes;
+  d.stats->last_active_time = TASK_TIME_NOW();
+}
+
+/**
+ * @brief Wait the fd for event, return false if the relay has been idle
+ * for too long or cancelled
+*/
+static bool __relay_wait(__relay_direction_t& d, SOCKET_T fd, EventType event_type) {
+  while (true) {
+    // Bytes moved by the other direction also keep the relay alive
+    auto idle_end = d.stats->last_active_time + d.options.idle_timeout;
+    auto now = TASK_TIME_NOW();
+    if (now >= idle_end) {
+      d.stats->idle_timedout = true;
+      return false;
+    }
+    task::this_task().wait_fd_for_event(fd, event_type, idle_end - now);
+    auto sig = task::this_task().signal();
+    if (sig == kWaitingSignalReceived) return true;
+    if (sig == kWaitingSignalBroken) {
+      // A hang-up may still leave data to read, let the syscall tell
+      return !task::this_task().is_cancelled();
+    }
+  }
+}
+
+/**
+ * @brief Copy from <i> to <o> through a bounded buffer, no more reading
+ * until the buffer has been written out
+*/
+static RelayEnd __relay_copy(__relay_direction_t& d) {
+  SOCKET_T fd = d.i->native_fd();
+  std::unique_ptr<char[]> buffer(new char[d.options.buffer_size]);
+  while (true) {
+    auto ret = ::recv(fd, buffer.get(), d.options.buffer_size, 0 | SO_NETWORK_NOSIGNAL);
+    if (ret == 0) return kRelayEndClosed;
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return kRelayEndFailed;
+      if (!__relay_wait(d, fd, kEventTypeRead)) return kRelayEndFailed;
+      continue;
+    }
+    size_t length = (size_t)ret;
+    size_t sent = 0;
+    while (sent < length) {
+      auto n = d.o->try_write(buffer.get() + sent, length - sent);
+      if (n < 0) return kRelayEndFailed;
+      if (n > 0) {
+        sent += (size_t)n;
+        __relay_moved(d, (size_t)n);
+        continue;
+      }
+      // The writing side is slow, stop reading until it drains
+      if (!__relay_wait(d, d.o->native_fd(), kEventTypeWrite)) return kRelayEndFailed;
+    }
+  }
+}
+
+#if PECO_TARGET_LINUX
+/**
+ * @brief Move from <i> to <o> by splice through the pipe, the pipe is the
+ * bounded buffer
+*/
+static RelayEnd __relay_splice(__relay_direction_t& d, int pipe_fds[2]) {
+  SOCKET_T in_fd = d.i->native_fd();
+  SOCKET_T out_fd = d.o->native_fd();
+  const unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+  while (true) {
+    auto ret = ::splice(in_fd, NULL, pipe_fds[1], NULL, d.options.buffer_size, flags);
+    if (ret == 0) return kRelayEndClosed;
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN) return kRelayEndFailed;
+      // The pipe is always drained, so the socket is empty
+      if (!__relay_wait(d, in_fd, kEventTypeRead)) return kRelayEndFailed;
+      continue;
+    }
+    size_t pending = (size_t)ret;
+    while (pending > 0) {
+      auto sent = ::splice(pipe_fds[0], NULL, out_fd, NULL, pending, flags);
+      if (sent < 0) {
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN) return kRelayEndFailed;
+        // The writing side is slow, stop reading until it drains
+        if (!__relay_wait(d, out_fd, kEventTypeWrite)) return kRelayEndFailed;
+        continue;
+      }
+      pending -= (size_t)sent;
+      __relay_moved(d, (size_t)sent);
+    }
+  }
+}
+#endif
+
+/**
+ * @brief Run one direction in a task
+*/
+static task __relay_run(__relay_direction_t d, std::shared_ptr<task> other) {
+  d.stats->running += 1;
+  return loop::shared()->run([d, other]() mutable {
+    // The relay outlives the request which starts it, only the idle
+    // timeout ends it
+    task::this_task().set_deadline(task_time_t::max());
+    RelayEnd end = kRelayEndFailed;
+#if PECO_TARGET_LINUX
+    int pipe_fds[2] = {-1, -1};
+    if (d.stats->zero_copy && ::pipe2(pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+      log::warning << "Warning: failed to create the relay pipe, " << ::strerror(errno)
+        << ", fall back to copy" << std::endl;
+      d.stats->zero_copy = false;
+    }
+    if (d.stats->zero_copy) {
+      // Best effort, the kernel rounds it up to pages
+      ignore_result(::fcntl(pipe_fds[1], F_SETPIPE_SZ, (int)d.options.buffer_size));
+      end = __relay_splice(d, pipe_fds);
+      ::close(pipe_fds[0]);
+      ::close(pipe_fds[1]);
+    } else {
+      end = __relay_copy(d);
+    }
+#else
+    end = __relay_copy(d);
+#endif
+    if (end == kRelayEndClosed) {
+      // Pass the half-close on
+      ::shutdown(d.o->native_fd(), SHUT_WR);
+    } else {
+      // Let both peers know the relay is over
+      ::shutdown(d.i->native_fd(), SHUT_RDWR);
+      ::shutdown(d.o->native_fd(), SHUT_RDWR);
+      if (other->is_alive()) other->cancel();
+    }
+    d.stats->running -= 1;
+    if (d.stats->running == 0) d.stats->end_time = TASK_TIME_NOW();
+  }, "relay");
+}
+
+/**
+ * @brief Relay bytes between two connectors in both directions. When one
+ * side closes its writing, the other side is shut down for writing and
+ * the other direction keeps going, any error or the idle timeout stops
+ * both directions. The directions do not inherit the caller's deadline. Each direction buffers at most options.buffer_size
+ * bytes, so a slow side pushes back on the fast one.
+*/
+std::shared_ptr<relay_stats> relay(
+  std::shared_ptr<connector_adapter> i,
+  std::shared_ptr<connector_adapter> o,
+  const relay_options& options
+) {
+  auto stats = std::make_shared<relay_stats>();
+  stats->start_time = TASK_TIME_NOW();
+  stats->last_active_time = stats->start_time;
+  if (i == nullptr || o == nullptr) return stats;
+  if (!i->is_connected() || !o->is_connected()) return stats;
+  if (options.buffer_size == 0) return stats;
+#if PECO_TARGET_LINUX
+  stats->zero_copy = (options.mode != kRelayModeCopy &&
+    net_utils::socktype(i->native_fd()) != kSocketTypeUDP &&
+    net_utils::socktype(o->native_fd()) != kSocketTypeUDP);
+#endif
+  auto to_in = std::make_shared<task>();
+  auto to_out = std::make_shared<task>();
+  *to_out = __relay_run(__relay_direction_t{i, o, stats, options, &stats->in_to_out}, to_in);
+  *to_in = __relay_run(__relay_direction_t{o, i, stats, options, &stats->out_to_in}, to_out);
+  return stats;
+}
+std::shared_ptr<relay_stats> relay(
+  std::shared_ptr<connector_adapter> i,
+  std::shared_ptr<connector_adapter> o,
+  RelayMode mode
+) {
+  relay_options options;
+  options.mode = mode;
+  return relay(i, o, options);
+}
+
+} // namespace peco
+
+// Push Chen
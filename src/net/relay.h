@@ -0,0 +1,143 @@
+/*
+    relay.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_NET_RELAY_H__
+#define PECO_NET_RELAY_H__
+
+#include "net/adapter.h"
+
+namespace peco {
+
+#ifndef PECO_NET_RELAY_BUFFER_SIZE
+// Default bytes buffered by each direction of a relay
+#define PECO_NET_RELAY_BUFFER_SIZE  65536   // 64KB
+#endif
+
+/**
+ * @brief How a relay moves the bytes
+*/
+enum RelayMode {
+  /**
+   * @brief Zero-copy when possible, otherwise copy
+  */
+  kRelayModeAuto,
+  /**
+   * @brief Read into user space and write back out
+  */
+  kRelayModeCopy,
+  /**
+   * @brief Move bytes in the kernel with splice through a pipe, only
+   * on Linux, falls back to copy if the pipe cannot be created
+  */
+  kRelayModeSplice
+};
+
+/**
+ * @brief Options of a relay
+*/
+struct relay_options {
+  /**
+   * @brief How to move the bytes
+  */
+  RelayMode   mode = kRelayModeAuto;
+  /**
+   * @brief Max bytes held by each direction, a direction stops reading
+   * until the buffered bytes have been written out
+  */
+  size_t      buffer_size = PECO_NET_RELAY_BUFFER_SIZE;
+  /**
+   * @brief Stop the relay if no byte moves in either direction for this long
+  */
+  duration_t  idle_timeout = PECO_TIME_S(1800);
+};
+
+/**
+ * @brief Counters of a relay, updated while relaying
+*/
+struct relay_stats {
+  /**
+   * @brief Bytes moved from the incoming side to the outgoing side
+  */
+  uint64_t    in_to_out = 0;
+  /**
+   * @brief Bytes moved from the outgoing side to the incoming side
+  */
+  uint64_t    out_to_in = 0;
+  /**
+   * @brief If the bytes are moved by splice
+  */
+  bool        zero_copy = false;
+  /**
+   * @brief Count of directions still running, 0 when the relay is over
+  */
+  int         running = 0;
+  /**
+   * @brief If the relay was stopped by the idle timeout
+  */
+  bool        idle_timedout = false;
+  /**
+   * @brief When the relay started, the last byte moved, and the relay
+   * stopped, end_time is task_time_t::max() while running
+  */
+  task_time_t start_time;
+  task_time_t last_active_time;
+  task_time_t end_time = task_time_t::max();
+
+  /**
+   * @brief Average bytes per second of each direction over the relay's life
+  */
+  double in_to_out_rate() const;
+  double out_to_in_rate() const;
+};
+
+/**
+ * @brief Relay bytes between two connectors in both directions. When one
+ * side closes its writing, the other side is shut down for writing and
+ * the other direction keeps going, any error or the idle timeout stops
+ * both directions. The directions do not inherit the caller's deadline. Each direction buffers at most options.buffer_size
+ * bytes, so a slow side pushes back on the fast one.
+*/
+std::shared_ptr<relay_stats> relay(
+  std::shared_ptr<connector_adapter> i,
+  std::shared_ptr<connector_adapter> o,
+  const relay_options& options);
+std::shared_ptr<relay_stats> relay(
+  std::shared_ptr<connector_adapter> i,
+  std::shared_ptr<connector_adapter> o,
+  RelayMode mode = kRelayModeAuto);
+
+} // namespace peco
+
+#endif
+
+// Push Chen
@@ -0,0 +1,167 @@
+/*
+    shard.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "net/shard.h"
+#include "task.h"
+#include "basic/logs.h"
+
+#if PECO_TARGET_LINUX
+#include <linux/filter.h>
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF    51
+#endif
+#endif
+
+namespace peco {
+
+/**
+ * @brief Factory
+*/
+std::shared_ptr<tcp_shard_listener> tcp_shard_listener::create(
+  std::shared_ptr<shared::loop_group> group, ShardPolicy policy
+) {
+  return std::shared_ptr<tcp_shard_listener>(new tcp_shard_listener(group, policy));
+}
+
+tcp_shard_listener::tcp_shard_listener(std::shared_ptr<shared::loop_group> group, ShardPolicy policy)
+  : group_(group), policy_(policy) { }
+
+tcp_shard_listener::~tcp_shard_listener() { }
+
+/**
+ * @brief Bind the address with one socket for each loop
+*/
+bool tcp_shard_listener::bind(const peer_t& local_addr) {
+  if (group_ == nullptr || group_->size() == 0) return false;
+  if (shards_.size() > 0) return false;
+  for (size_t i = 0; i < group_->size(); ++i) {
+    auto tl = tcp_listener::create();
+    if (!net_utils::reuseport(tl->native_fd(), true) || !tl->bind(local_addr)) {
+      log::error << "failed to bind shard " << i << " on " << local_addr.str() << std::endl;
+      shards_.clear();
+      return false;
+    }
+    shards_.push_back(tl);
+  }
+  return true;
+}
+bool tcp_shard_listener::bind(const std::string& local_addr) {
+  return this->bind(peer_t(local_addr));
+}
+
+/**
+ * @brief Limit the connections being served by each shard, see
+ * tcp_listener::set_max_connections, set it before listening
+*/
+void tcp_shard_listener::set_max_connections(size_t max_connections) {
+  max_connections_ = max_connections;
+}
+
+/**
+ * @brief Start listening in every loop. On failure, the shards already
+ * listening are stopped and all sockets are closed, bind again to retry
+*/
+bool tcp_shard_listener::listen(std::function<void(std::shared_ptr<tcp_connector>)> accept_slot) {
+  if (shards_.size() == 0) return false;
+  // The kernel numbers the sockets in the order they start listening,
+  // so shard i is the socket of loop i
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    auto tl = shards_[i];
+    auto max_connections = max_connections_;
+    bool ok = false;
+    group_->at(i)->sync_inject([tl, max_connections, accept_slot, &ok]() {
+      tl->set_max_connections(max_connections);
+      ok = tl->listen(accept_slot);
+    });
+    if (!ok) {
+      log::error << "failed to listen on shard " << i << std::endl;
+      this->close_shards_();
+      return false;
+    }
+  }
+  // Every shard is accepting, the kernel hash still works without the policy
+  if (policy_ == kShardPolicyCpu && !this->attach_cpu_policy_()) {
+    log::warning << "Warning: fall back to hash for the shards" << std::endl;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the shard count
+*/
+size_t tcp_shard_listener::size() const {
+  return shards_.size();
+}
+
+/**
+ * @brief Attach the cpu policy to the reuseport group
+*/
+bool tcp_shard_listener::attach_cpu_policy_() {
+#if PECO_TARGET_LINUX
+  // A = cpu % shard count, the index of the socket to take the connection
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU) },
+    { BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint32_t)shards_.size() },
+    { BPF_RET | BPF_A, 0, 0, 0 }
+  };
+  struct sock_fprog prog;
+  prog.len = (unsigned short)(sizeof(code) / sizeof(code[0]));
+  prog.filter = code;
+  // The program belongs to the whole reuseport group
+  if (setsockopt(shards_[0]->native_fd(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+    &prog, sizeof(prog)) != 0) {
+    log::warning << "Warning: cannot attach the cpu policy, " << ::strerror(errno) << std::endl;
+    return false;
+  }
+  return true;
+#else
+  log::warning << "Warning: the cpu policy is only on Linux" << std::endl;
+  return false;
+#endif
+}
+
+/**
+ * @brief Stop the shards listening and close all sockets
+*/
+void tcp_shard_listener::close_shards_() {
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    auto tl = shards_[i];
+    // The listening task owns the listener, the socket is closed when it quits
+    group_->at(i)->sync_inject([tl]() {
+      if (tl->accept_tid_ != kInvalidateTaskId) task(tl->accept_tid_).cancel();
+    });
+  }
+  shards_.clear();
+}
+
+} // namespace peco
+
+// Push Chen
@@ -0,0 +1,126 @@
+/*
+    shard.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_NET_SHARD_H__
+#define PECO_NET_SHARD_H__
+
+#include "net/tcp.h"
+#include "task/shared/loopgroup.h"
+
+#include <vector>
+
+namespace peco {
+
+/**
+ * @brief How the kernel picks the shard of a new connection
+*/
+enum ShardPolicy {
+  /**
+   * @brief The kernel's default, by the hash of the connection's addresses
+  */
+  kShardPolicyHash,
+  /**
+   * @brief The shard at index (cpu % shard count), where cpu is the one
+   * handling the incoming packet, only on Linux. Use with a pinned group
+   * whose loop i runs on cpu i, so a connection stays on one cpu. Falls
+   * back to the hash if the kernel does not support it
+  */
+  kShardPolicyCpu
+};
+
+/**
+ * @brief Listen on the same address in every loop of a group. Each loop
+ * owns a SO_REUSEPORT socket, accepts by itself and serves the connections
+ * it accepted, so accepting and serving scale with the loops. The accept
+ * slot runs in the loops at the same time.
+*/
+class tcp_shard_listener : public std::enable_shared_from_this<tcp_shard_listener> {
+public:
+  /**
+   * @brief Factory
+  */
+  static std::shared_ptr<tcp_shard_listener> create(
+    std::shared_ptr<shared::loop_group> group,
+    ShardPolicy policy = kShardPolicyHash);
+
+  ~tcp_shard_listener();
+
+public:
+  /**
+   * @brief Bind the address with one socket for each loop
+  */
+  bool bind(const peer_t& local_addr);
+  bool bind(const std::string& local_addr);
+
+  /**
+   * @brief Limit the connections being served by each shard, see
+   * tcp_listener::set_max_connections, set it before listening
+  */
+  void set_max_connections(size_t max_connections);
+
+  /**
+   * @brief Start listening in every loop. On failure, the shards already
+   * listening are stopped and all sockets are closed, bind again to retry
+  */
+  bool listen(std::function<void(std::shared_ptr<tcp_connector>)> accept_slot);
+
+  /**
+   * @brief Get the shard count
+  */
+  size_t size() const;
+
+protected:
+  tcp_shard_listener(std::shared_ptr<shared::loop_group> group, ShardPolicy policy);
+
+  /**
+   * @brief Attach the cpu policy to the reuseport group
+  */
+  bool attach_cpu_policy_();
+
+  /**
+   * @brief Stop the shards listening and close all sockets
+  */
+  void close_shards_();
+
+protected:
+  std::shared_ptr<shared::loop_group>           group_;
+  ShardPolicy                                   policy_;
+  std::vector<std::shared_ptr<tcp_listener>>    shards_;
+  size_t                                        max_connections_ = 0;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
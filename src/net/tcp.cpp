@@ -33,6 +33,14 @@ SOFTWARE.
 #include "basic/logs.h"
 #include "net/bind.h"
 #include "net/connect.h"
+#include "task.h"
+
+#if PECO_TARGET_LINUX
+#include <linux/errqueue.h>
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY       5
+#endif
+#endif
 
 namespace peco {
 
@@ -76,6 +84,140 @@ bool tcp_connector::connect(const std::string& dest_addr, duration_t timeout) {
   return connector_adapter::connect(tcp_connect(dest_addr, timeout));
 }
 
+/**
+ * @brief Write data to peer socket, in zero-copy mode the data is sent
+ * by MSG_ZEROCOPY when it is not smaller than the threshold, and the
+ * task is parked until the kernel no longer uses the data
+*/
+bool tcp_connector::write(const char* data, size_t length, duration_t timedout) {
+  if (!zero_copy_ || length < zero_copy_threshold_) {
+    return connector_adapter::write(data, length, timedout);
+  }
+  return this->write_zero_copy_(data, length, timedout);
+}
+
+/**
+ * @brief Turn on the zero-copy mode for large writes, only on Linux
+*/
+bool tcp_connector::set_zero_copy(bool enable, size_t threshold) {
+  if (enable == zero_copy_) {
+    zero_copy_threshold_ = threshold;
+    return true;
+  }
+  if (!net_utils::zerocopy(fd_, enable)) return false;
+  zero_copy_ = enable;
+  zero_copy_threshold_ = threshold;
+  return true;
+}
+
+/**
+ * @brief Tell if the zero-copy mode is on
+*/
+bool tcp_connector::is_zero_copy() const {
+  return zero_copy_;
+}
+
+/**
+ * @brief Send the data by MSG_ZEROCOPY and wait for the completions
+*/
+bool tcp_connector::write_zero_copy_(const char* data, size_t length, duration_t timedout) {
+#if PECO_TARGET_LINUX
+  if (SOCKET_NOT_VALIDATE(fd_)) return false;
+  if (!is_connected()) return false;
+  // The request has already missed its deadline
+  if (task::this_task().is_deadline_exceeded()) return false;
+  // Completions come with EPOLLERR, they must not break other waiters
+  loop::shared()->watch_fd_errors(fd_);
+  bool ok = true;
+  size_t sent = 0;
+  while (sent < length) {
+    auto ret = ::send(fd_, data + sent, length - sent, MSG_ZEROCOPY | SO_NETWORK_NOSIGNAL);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno == ENOBUFS) {
+        // Out of the pinned memory limit, copy the rest
+        ok = connector_adapter::write(data + sent, length - sent, timedout);
+        break;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        log::warning << "Failed to send data on socket(" << fd_ << "), "
+          << ::strerror(errno) << std::endl;
+        ok = false;
+        break;
+      }
+      task::this_task().wait_fd_for_event(fd_, kEventTypeWrite, timedout);
+      if (task::this_task().signal() != kWaitingSignalReceived) {
+        ok = false;
+        break;
+      }
+      continue;
+    }
+    zero_copy_sent_ += 1;
+    sent += (size_t)ret;
+  }
+  // The kernel may still read the data until all sends are completed,
+  // so the caller must not get the buffer back before that
+  while (zero_copy_done_ != zero_copy_sent_) {
+    if (!this->reap_zero_copy_()) {
+      ok = false;
+      break;
+    }
+    if (zero_copy_done_ == zero_copy_sent_) break;
+    task::this_task().wait_fd_for_event(fd_, kEventTypeError, timedout);
+    auto sig = task::this_task().signal();
+    if (sig == kWaitingSignalReceived) continue;
+    if (sig == kWaitingSignalBroken && this->reap_zero_copy_() &&
+      zero_copy_done_ == zero_copy_sent_) break;
+    log::warning << "Warning: zero-copy sends on socket(" << fd_
+      << ") are not completed" << std::endl;
+    ok = false;
+    break;
+  }
+  loop::shared()->release_fd_errors(fd_);
+  return ok;
+#else
+  return connector_adapter::write(data, length, timedout);
+#endif
+}
+
+/**
+ * @brief Read the completions from the error queue, false on socket error
+*/
+bool tcp_connector::reap_zero_copy_() {
+#if PECO_TARGET_LINUX
+  while (true) {
+    char control[128];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto ret = ::recvmsg(fd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    for (auto cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+      bool is_recverr = (
+        (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+        (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)
+      );
+      if (!is_recverr) continue;
+      struct sock_extended_err serr;
+      memcpy(&serr, CMSG_DATA(cm), sizeof(serr));
+      if (serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+        log::warning << "Warning: socket(" << fd_ << ") error, "
+          << ::strerror((int)serr.ee_errno) << std::endl;
+        return false;
+      }
+      // Sends in [ee_info, ee_data] are completed
+      zero_copy_done_ += (serr.ee_data - serr.ee_info + 1);
+    }
+  }
+#else
+  return true;
+#endif
+}
+
 /**
  * @brief Get local port
 */
@@ -106,6 +248,27 @@ tcp_connector::tcp_connector(SOCKET_T fd)
   net_utils::reusable(fd_, true);
   net_utils::keepalive(fd_, true);
 }
+tcp_connector::tcp_connector(SOCKET_T fd, bool inherited)
+  : connector_adapter(fd, true) {
+  if (inherited) return;
+  net_utils::nonblocking(fd_, true);
+  net_utils::nodelay(fd_, true);
+  net_utils::reusable(fd_, true);
+  net_utils::keepalive(fd_, true);
+}
+
+/**
+ * @brief Create a tcp connector with an accepted fd, which is already
+ * nonblocking and has inherited the listener's options
+*/
+std::shared_ptr<tcp_connector> tcp_connector::create_accepted_(SOCKET_T fd) {
+#if PECO_TARGET_LINUX
+  // accept4 makes it nonblocking, nodelay and keepalive come from the listener
+  return std::shared_ptr<tcp_connector>(new tcp_connector(fd, true));
+#else
+  return std::shared_ptr<tcp_connector>(new tcp_connector(fd, false));
+#endif
+}
 
 
 tcp_listener::~tcp_listener() { }
@@ -127,6 +290,14 @@ bool tcp_listener::bind(const std::string& local_addr) {
   return inet_adapter::bind(peer_bind(local_addr));
 }
 
+// Invoke the callback when the accept slot returns, including being cancelled
+class __tcp_slot_guard {
+  std::function<void()> on_exit_;
+public:
+  __tcp_slot_guard(std::function<void()> on_exit) : on_exit_(on_exit) { }
+  ~__tcp_slot_guard() { on_exit_(); }
+};
+
 /**
  * @brief Listen on the binded socket
 */
@@ -140,6 +311,8 @@ bool tcp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
   loop::shared()->run([=]() {
     std::string task_name = "tcp_listen:" + std::to_string(net_utils::localport(fd_));
     task::this_task().set_name(task_name.c_str());
+    task::this_task().set_listener();
+    self->accept_tid_ = task::this_task().task_id();
     while (true) {
       task::this_task().wait_fd_for_event(self->fd_, kEventTypeRead, PECO_TIME_S(1800));
       auto sig = task::this_task().signal();
@@ -147,21 +320,63 @@ bool tcp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
         // task cancelled
         return;
       }
-      if (sig == kWaitingSignalNothing) continue;
+      if (sig == kWaitingSignalNothing) {
+        // Only a deadline set on the listener itself ends it
+        if (task::this_task().is_deadline_exceeded()) return;
+        continue;
+      }
+      // The fd is edge triggered, drain the backlog
+      size_t accepted = 0;
       while(true) {
-        struct sockaddr in_addr;
-        socklen_t in_len = 0;
-        memset(&in_addr, 0, sizeof(in_len));
-        SOCKET_T in_fd = accept(self->fd_, &in_addr, &in_len);
+        if (self->max_connections_ > 0 && self->connections_ >= self->max_connections_) {
+          // Full, the rest wait in the backlog until a slot is over
+          self->accept_paused_ = true;
+          task::this_task().holding();
+          self->accept_paused_ = false;
+          if (task::this_task().is_cancelled() || task::this_task().is_deadline_exceeded()) return;
+          continue;
+        }
+        if (accepted == PECO_NET_ACCEPT_BATCH) {
+          // Let the new connections run before accepting more
+          accepted = 0;
+          task::this_task().yield();
+          if (task::this_task().is_cancelled() || task::this_task().is_deadline_exceeded()) return;
+        }
+        struct sockaddr_in in_addr;
+        socklen_t in_len = sizeof(in_addr);
+        memset(&in_addr, 0, sizeof(in_addr));
+#if PECO_TARGET_LINUX
+        SOCKET_T in_fd = ::accept4(self->fd_, (struct sockaddr *)&in_addr, &in_len,
+          SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        SOCKET_T in_fd = ::accept(self->fd_, (struct sockaddr *)&in_addr, &in_len);
+#endif
         if (in_fd == -1) {
           if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+          if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) continue;
+          if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+            // Out of resources, the connections stay in the backlog
+            log::warning << "Warning: failed to accept on socket(" << self->fd_
+              << "), " << ::strerror(errno) << ", retry later" << std::endl;
+            task::this_task().sleep(PECO_TIME_MS(100));
+            if (task::this_task().is_cancelled() || task::this_task().is_deadline_exceeded()) return;
+            continue;
+          }
           // On error
+          log::error << "failed to accept on socket(" << self->fd_ << "), error: "
+            << ::strerror(errno) << std::endl;
           return;
-        } else {
-          loop::shared()->run([=]() {
-            accept_slot(in_fd, net_utils::socket_peerinfo(in_fd));
-          });
         }
+        ++accepted;
+        self->connections_ += 1;
+        peer_t remote_addr(in_addr);
+        loop::shared()->run([=]() {
+          // The slot may replace the task's atexit, count it by ourselves
+          __tcp_slot_guard _([self]() {
+            self->connection_closed_();
+          });
+          accept_slot(in_fd, remote_addr);
+        });
       }
     }
   }, PECO_CODE_LOCATION);
@@ -172,10 +387,35 @@ bool tcp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
 */
 bool tcp_listener::listen(std::function<void(std::shared_ptr<tcp_connector>)> accept_slot) {
   return this->listen([=](SOCKET_T fd, const peer_t& remote_addr) {
-    accept_slot(tcp_connector::create(fd));
+    accept_slot(tcp_connector::create_accepted_(fd));
   });
 }
 
+/**
+ * @brief Limit the connections being served, which are the accept slots
+ * still running, new connections wait in the backlog when reaching the
+ * limit. 0 means no limit, which is the default
+*/
+void tcp_listener::set_max_connections(size_t max_connections) {
+  max_connections_ = max_connections;
+  if (accept_paused_) task(accept_tid_).wakeup();
+}
+
+/**
+ * @brief Count of the accept slots still running
+*/
+size_t tcp_listener::connections() const {
+  return connections_;
+}
+
+/**
+ * @brief An accept slot is over, go on accepting if paused
+*/
+void tcp_listener::connection_closed_() {
+  connections_ -= 1;
+  if (accept_paused_) task(accept_tid_).wakeup();
+}
+
 /**
  * @brief Not allowed
 */
@@ -38,6 +38,16 @@ SOFTWARE.
 
 namespace peco {
 
+#ifndef PECO_NET_ZEROCOPY_THRESHOLD
+// Writes smaller than this are copied even in zero-copy mode
+#define PECO_NET_ZEROCOPY_THRESHOLD   65536   // 64KB
+#endif
+
+#ifndef PECO_NET_ACCEPT_BATCH
+// Max connections accepted in a row before yielding to other tasks
+#define PECO_NET_ACCEPT_BATCH         64
+#endif
+
 class tcp_connector : public connector_adapter {
 public:
   virtual ~tcp_connector();
@@ -70,6 +80,23 @@ public:
   using connector_adapter::read;
   using connector_adapter::write;
 
+  /**
+   * @brief Write data to peer socket, in zero-copy mode the data is sent
+   * by MSG_ZEROCOPY when it is not smaller than the threshold, and the
+   * task is parked until the kernel no longer uses the data
+  */
+  bool write(const char* data, size_t length, duration_t timedout = PECO_TIME_S(10)) override;
+
+  /**
+   * @brief Turn on the zero-copy mode for large writes, only on Linux
+  */
+  bool set_zero_copy(bool enable, size_t threshold = PECO_NET_ZEROCOPY_THRESHOLD);
+
+  /**
+   * @brief Tell if the zero-copy mode is on
+  */
+  bool is_zero_copy() const;
+
   /**
    * @brief Get local port
   */
@@ -84,6 +111,30 @@ protected:
   */
   tcp_connector();
   tcp_connector(SOCKET_T fd);
+  tcp_connector(SOCKET_T fd, bool inherited);
+
+  friend class tcp_listener;
+  /**
+   * @brief Create a tcp connector with an accepted fd, which is already
+   * nonblocking and has inherited the listener's options
+  */
+  static std::shared_ptr<tcp_connector> create_accepted_(SOCKET_T fd);
+
+  /**
+   * @brief Send the data by MSG_ZEROCOPY and wait for the completions
+  */
+  bool write_zero_copy_(const char* data, size_t length, duration_t timedout);
+  /**
+   * @brief Read the completions from the error queue, false on socket error
+  */
+  bool reap_zero_copy_();
+
+protected:
+  bool zero_copy_ = false;
+  size_t zero_copy_threshold_ = PECO_NET_ZEROCOPY_THRESHOLD;
+  // Count of zero-copy sends, and the completed ones
+  uint32_t zero_copy_sent_ = 0;
+  uint32_t zero_copy_done_ = 0;
 };
 
 class tcp_listener : public listener_adapter, public std::enable_shared_from_this<tcp_listener> {
@@ -106,6 +157,18 @@ public:
   */
   bool listen(std::function<void(std::shared_ptr<tcp_connector>)> accept_slot);
 
+  /**
+   * @brief Limit the connections being served, which are the accept slots
+   * still running, new connections wait in the backlog when reaching the
+   * limit. 0 means no limit, which is the default
+  */
+  void set_max_connections(size_t max_connections);
+
+  /**
+   * @brief Count of the accept slots still running
+  */
+  size_t connections() const;
+
 protected:
   /**
    * @brief Listen on the binded socket
@@ -117,6 +180,20 @@ protected:
    * @brief Not allowed
   */
   tcp_listener();
+
+  /**
+   * @brief An accept slot is over, go on accepting if paused
+  */
+  void connection_closed_();
+
+protected:
+  size_t max_connections_ = 0;
+  size_t connections_ = 0;
+  // The listening task, holding when connections reach the limit
+  task_id_t accept_tid_ = kInvalidateTaskId;
+  bool accept_paused_ = false;
+
+  friend class tcp_shard_listener;
 };
 
 } // namespace peco
@@ -34,8 +34,112 @@ SOFTWARE.
 #include "net/connect.h"
 #include "basic.h"
 
+#if PECO_TARGET_LINUX
+#include <netinet/udp.h>
+// UDP segmentation offload, older headers may not have them
+#ifndef SOL_UDP
+#define SOL_UDP                     17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO                     104
+#endif
+#endif
+
 namespace peco {
 
+/**
+ * @brief Max bytes sent by one syscall, a GSO send carries at most 64
+ * segments and must fit in one IP packet
+*/
+static size_t __udp_chunk_size(size_t gso_size) {
+  if (gso_size == 0) return PECO_NET_UDP_SEGMENT_SIZE;
+  size_t segments = std::min<size_t>(64, 65000 / gso_size);
+  return std::max<size_t>(segments, 1) * gso_size;
+}
+
+/**
+ * @brief Send data to the address, split into chunks
+*/
+static bool __udp_writeto(
+  SOCKET_T fd, struct sockaddr_in addr, const char* data, size_t length, size_t gso_size
+) {
+  if (length == 0) return false;
+  size_t chunk = __udp_chunk_size(gso_size);
+  size_t sent = 0;
+  do {
+    int ret = net_utils::write(fd, data + sent,
+      (length - sent < chunk ? length - sent : chunk),
+      std::bind(::sendto,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        std::placeholders::_3,
+        0 | SO_NETWORK_NOSIGNAL,
+        (struct sockaddr *)&addr,
+        sizeof(addr)
+      )
+    );
+    if (ret == -1) return false;
+    sent += (size_t)ret;
+  } while (sent < length);
+  return true;
+}
+
+/**
+ * @brief Receive one datagram, or the coalesced datagrams with their
+ * segment size, through the scratch buffer. Return 1 if received, 0 if
+ * nothing to read, -1 on error
+*/
+static int __udp_recv_packet(
+  SOCKET_T fd, std::string& scratch, std::string& buffer,
+  struct sockaddr_in& addr, size_t& segment_size
+) {
+  segment_size = 0;
+  ssize_t ret = 0;
+#if PECO_TARGET_LINUX
+  struct iovec iov;
+  iov.iov_base = &scratch[0];
+  iov.iov_len = scratch.size();
+  char control[CMSG_SPACE(sizeof(int))];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &addr;
+  msg.msg_namelen = sizeof(addr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  do {
+    ret = ::recvmsg(fd, &msg, MSG_DONTWAIT);
+  } while (ret < 0 && errno == EINTR);
+#else
+  socklen_t addr_len = sizeof(addr);
+  do {
+    ret = ::recvfrom(fd, &scratch[0], scratch.size(), 0, (struct sockaddr *)&addr, &addr_len);
+  } while (ret < 0 && errno == EINTR);
+#endif
+  if (ret < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+    log::error << "Error: Failed to receive data on socket(" << fd << ", "
+      << ::strerror(errno) << std::endl;
+    return -1;
+  }
+  buffer.assign(scratch.data(), (size_t)ret);
+#if PECO_TARGET_LINUX
+  for (auto cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+    if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+      int gso_size = 0;
+      memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+      // A single datagram is not coalesced
+      if ((size_t)gso_size < buffer.size()) segment_size = (size_t)gso_size;
+    }
+  }
+#endif
+  return 1;
+}
+
 udp_connector::~udp_connector() {}
 
 /**
@@ -160,9 +264,11 @@ bool udp_listener::listen(std::function<void(std::shared_ptr<udp_packet>)> accep
   loop::shared()->run([self, accept_slot]() {
     std::string task_name = "udp_listen_packet:" + std::to_string(net_utils::localport(self->fd_));
     task::this_task().set_name(task_name.c_str());
+    task::this_task().set_listener();
 
     struct sockaddr_in addr;
-    socklen_t addr_len = sizeof(addr);
+    // Big enough for any datagram, or the coalesced ones
+    std::string scratch(65536, '\0');
     while (true) {
       task::this_task().wait_fd_for_event(self->fd_, kEventTypeRead, PECO_TIME_S(1800));
       auto sig = task::this_task().signal();
@@ -170,22 +276,22 @@ bool udp_listener::listen(std::function<void(std::shared_ptr<udp_packet>)> accep
         // task cancelled
         return;
       }
-      if (sig == kWaitingSignalNothing) continue;
-      std::string buffer;
-      bool ret = net_utils::read(
-        buffer, self->fd_, std::bind(::recvfrom, 
-          std::placeholders::_1,
-          std::placeholders::_2,
-          std::placeholders::_3,
-          0,
-          (struct sockaddr *)&addr,
-          &addr_len
-        ), 2048);
-      if (ret == false) {
-        break;
+      if (sig == kWaitingSignalNothing) {
+        // Only a deadline set on the listener itself ends it
+        if (task::this_task().is_deadline_exceeded()) return;
+        continue;
       }
-      if (buffer.size() > 0) {
-        accept_slot(udp_packet::create(self->fd_, peer_t(addr), std::move(buffer)));
+      // The fd is edge triggered, drain the socket
+      while (true) {
+        std::string buffer;
+        size_t segment_size = 0;
+        int ret = __udp_recv_packet(self->fd_, scratch, buffer, addr, segment_size);
+        if (ret < 0) return;
+        if (ret == 0) break;
+        if (buffer.size() > 0) {
+          accept_slot(udp_packet::create(self->fd_, peer_t(addr), std::move(buffer),
+            segment_size, self->gso_size_));
+        }
       }
     }
   }, PECO_CODE_LOCATION).set_atexit([self]() {
@@ -194,6 +300,119 @@ bool udp_listener::listen(std::function<void(std::shared_ptr<udp_packet>)> accep
   return true;
 }
 
+/**
+ * @brief Reused buffers of a batch listener
+*/
+struct __udp_arena {
+  char                  data[PECO_NET_UDP_BATCH_SIZE][PECO_NET_UDP_PACKET_SIZE];
+  struct sockaddr_in    addrs[PECO_NET_UDP_BATCH_SIZE];
+#if PECO_TARGET_LINUX
+  struct iovec          iovs[PECO_NET_UDP_BATCH_SIZE];
+  struct mmsghdr        msgs[PECO_NET_UDP_BATCH_SIZE];
+#endif
+  udp_datagram          datagrams[PECO_NET_UDP_BATCH_SIZE];
+};
+
+/**
+ * @brief Receive up to a batch of datagrams without waiting, return
+ * the count, 0 if nothing to read, -1 on error
+*/
+static int __udp_recv_batch(SOCKET_T fd, __udp_arena* arena) {
+  int count = 0;
+#if PECO_TARGET_LINUX
+  for (size_t i = 0; i < PECO_NET_UDP_BATCH_SIZE; ++i) {
+    arena->iovs[i].iov_base = arena->data[i];
+    arena->iovs[i].iov_len = PECO_NET_UDP_PACKET_SIZE;
+    memset(&arena->msgs[i], 0, sizeof(arena->msgs[i]));
+    arena->msgs[i].msg_hdr.msg_name = &arena->addrs[i];
+    arena->msgs[i].msg_hdr.msg_namelen = sizeof(arena->addrs[i]);
+    arena->msgs[i].msg_hdr.msg_iov = &arena->iovs[i];
+    arena->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  do {
+    count = ::recvmmsg(fd, arena->msgs, PECO_NET_UDP_BATCH_SIZE, MSG_DONTWAIT, NULL);
+  } while (count < 0 && errno == EINTR);
+  if (count < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+  for (int i = 0; i < count; ++i) {
+    arena->datagrams[i].length = arena->msgs[i].msg_len;
+    arena->datagrams[i].truncated = ((arena->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0);
+  }
+#else
+  for (; count < PECO_NET_UDP_BATCH_SIZE; ++count) {
+    socklen_t addr_len = sizeof(arena->addrs[count]);
+    auto ret = ::recvfrom(fd, arena->data[count], PECO_NET_UDP_PACKET_SIZE, 0,
+      (struct sockaddr *)&arena->addrs[count], &addr_len);
+    if (ret < 0) {
+      if (errno == EINTR) { --count; continue; }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      return (count > 0 ? count : -1);
+    }
+    arena->datagrams[count].length = (size_t)ret;
+    arena->datagrams[count].truncated = false;
+  }
+#endif
+  for (int i = 0; i < count; ++i) {
+    arena->datagrams[i].peer = arena->addrs[i];
+    arena->datagrams[i].data = arena->data[i];
+  }
+  return count;
+}
+
+/**
+ * @brief Listen on the binded socket in batch mode, each syscall receives
+ * up to PECO_NET_UDP_BATCH_SIZE datagrams into a reused arena, and the
+ * slot gets them all at once, without allocation per datagram. Not
+ * available with GRO, whose coalesced datagrams do not fit the arena
+*/
+bool udp_listener::listen_batch(std::function<void(const udp_datagram* datagrams, size_t count)> batch_slot) {
+  if (listened_) return false;
+  if (gro_) {
+    log::error << "cannot listen in batch mode on socket(" << fd_ << ") with GRO on" << std::endl;
+    return false;
+  }
+  listened_ = true;
+  batched_ = true;
+
+  auto self = this->shared_from_this();
+  loop::shared()->run([self, batch_slot]() {
+    std::string task_name = "udp_listen_batch:" + std::to_string(net_utils::localport(self->fd_));
+    task::this_task().set_name(task_name.c_str());
+    task::this_task().set_listener();
+
+    std::unique_ptr<__udp_arena> arena(new __udp_arena);
+    while (true) {
+      task::this_task().wait_fd_for_event(self->fd_, kEventTypeRead, PECO_TIME_S(1800));
+      auto sig = task::this_task().signal();
+      if (sig == kWaitingSignalBroken) {
+        // task cancelled
+        return;
+      }
+      if (sig == kWaitingSignalNothing) {
+        // Only a deadline set on the listener itself ends it
+        if (task::this_task().is_deadline_exceeded()) return;
+        continue;
+      }
+      // Drain the socket, fewer than a batch means it is empty
+      int count = 0;
+      do {
+        count = __udp_recv_batch(self->fd_, arena.get());
+        if (count < 0) {
+          log::warning << "Failed to receive datagrams on socket(" << self->fd_
+            << "), " << ::strerror(errno) << std::endl;
+          return;
+        }
+        if (count > 0) batch_slot(arena->datagrams, (size_t)count);
+      } while (count == PECO_NET_UDP_BATCH_SIZE);
+    }
+  }, PECO_CODE_LOCATION).set_atexit([self]() {
+    self->listened_ = false;
+    self->batched_ = false;
+  });
+  return true;
+}
+
 /**
  * @brief Listen on the binded socket
 */
@@ -205,6 +424,7 @@ bool udp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
   loop::shared()->run([=]() {
     std::string task_name = "udp_listen:" + std::to_string(net_utils::localport(fd_));
     task::this_task().set_name(task_name.c_str());
+    task::this_task().set_listener();
 
     struct sockaddr_in addr;
     socklen_t addr_len = sizeof(addr);
@@ -222,7 +442,11 @@ bool udp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
         // task cancelled
         // return;
       }
-      if (sig == kWaitingSignalNothing) continue;
+      if (sig == kWaitingSignalNothing) {
+        // Only a deadline set on the listener itself ends it
+        if (task::this_task().is_deadline_exceeded()) return;
+        continue;
+      }
       size_t l = ::recvfrom(self->fd_, NULL, 0, MSG_PEEK, (struct sockaddr *)&addr, &addr_len);
       if (l < 0) {
         // error
@@ -240,30 +464,59 @@ bool udp_listener::listen(listener_adapter::slot_accept_t accept_slot) {
  * @brief Write data to specified peer
 */
 bool udp_listener::writeto(const peer_t& peer, const char* data, size_t length) {
-  if (length == 0) return false;
-  size_t sent = 0;
-  struct sockaddr_in addr = (struct sockaddr_in)peer;
-  do {
-    int ret = net_utils::write(fd_, data + sent, 
-      (length - sent < 1500 ? length - sent : 1500), 
-      std::bind(::sendto, 
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3, 
-        0 | SO_NETWORK_NOSIGNAL,
-        (struct sockaddr *)&addr, 
-        sizeof(addr)
-      )
-    );
-    if (ret == -1) return false;
-    sent += (size_t)ret;
-  } while (sent < length);
-  return true;
+  return __udp_writeto(fd_, (struct sockaddr_in)peer, data, length, gso_size_);
 }
 bool udp_listener::writeto(const peer_t& peer, const std::string& data) {
   return this->writeto(peer, data.c_str(), data.size());
 }
 
+/**
+ * @brief Split writes into datagrams of <segment_size> in the kernel by
+ * UDP_SEGMENT, so up to 64 datagrams go out by one syscall. 0 to turn
+ * off. A udp_outbox on the socket still sends one datagram per writeto.
+ * Only on Linux
+*/
+bool udp_listener::set_gso(size_t segment_size) {
+#if PECO_TARGET_LINUX
+  int value = (int)segment_size;
+  if (setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &value, sizeof(value)) != 0) {
+    log::warning << "Warning: cannot set udp segment offload, "
+      << ::strerror(errno) << std::endl;
+    return false;
+  }
+  gso_size_ = segment_size;
+  return true;
+#else
+  ignore_result(segment_size);
+  return false;
+#endif
+}
+
+/**
+ * @brief Let the kernel coalesce datagrams of the same flow by UDP_GRO,
+ * a packet in packet mode may then carry many datagrams, see
+ * udp_packet::segment_size. Not available in batch mode. Only on Linux
+*/
+bool udp_listener::set_gro(bool enable) {
+#if PECO_TARGET_LINUX
+  if (enable && batched_) {
+    log::error << "cannot turn on GRO on socket(" << fd_ << ") listening in batch mode" << std::endl;
+    return false;
+  }
+  int value = (enable ? 1 : 0);
+  if (setsockopt(fd_, SOL_UDP, UDP_GRO, &value, sizeof(value)) != 0) {
+    log::warning << "Warning: cannot set udp receive offload, "
+      << ::strerror(errno) << std::endl;
+    return false;
+  }
+  gro_ = enable;
+  return true;
+#else
+  ignore_result(enable);
+  return false;
+#endif
+}
+
 /**
  * @brief Not allowed
 */
@@ -292,29 +545,19 @@ const std::string& udp_packet::data() const {
   return pkt_;
 }
 
+/**
+ * @brief Size of each datagram coalesced into this packet by GRO, the
+ * last one may be shorter. 0 if the packet is a single datagram
+*/
+size_t udp_packet::segment_size() const {
+  return segment_size_;
+}
+
 /**
  * @brief Write data back to origin addr
 */
 bool udp_packet::write(const char* data, size_t length) {
-  if (length == 0) return false;
-  size_t sent = 0;
-  struct sockaddr_in addr = source_addr_;
-  do {
-    int ret = net_utils::write(fd_, data + sent, 
-      (length - sent < 1500 ? length - sent : 1500), 
-      std::bind(::sendto, 
-        std::placeholders::_1,
-        std::placeholders::_2,
-        std::placeholders::_3, 
-        0 | SO_NETWORK_NOSIGNAL,
-        (struct sockaddr *)&addr, 
-        sizeof(addr)
-      )
-    );
-    if (ret == -1) return false;
-    sent += (size_t)ret;
-  } while (sent < length);
-  return true;
+  return __udp_writeto(fd_, (struct sockaddr_in)source_addr_, data, length, gso_size_);
 }
 bool udp_packet::write(const std::string& data) {
   return this->write(data.c_str(), data.size());
@@ -323,16 +566,168 @@ bool udp_packet::write(const std::string& data) {
 /**
  * @brief Static create for udp_listener
 */
-std::shared_ptr<udp_packet> udp_packet::create(SOCKET_T fd, const peer_t& addr, std::string&& pkt) {
-  return std::shared_ptr<udp_packet>(new udp_packet(fd, addr, std::move(pkt)));
+std::shared_ptr<udp_packet> udp_packet::create(
+  SOCKET_T fd, const peer_t& addr, std::string&& pkt,
+  size_t segment_size, size_t gso_size
+) {
+  return std::shared_ptr<udp_packet>(
+    new udp_packet(fd, addr, std::move(pkt), segment_size, gso_size));
 }
 /**
  * @brief Build a udp packet
 */
-udp_packet::udp_packet(SOCKET_T fd, const peer_t& addr, std::string&& pkt)
-  : fd_(fd), source_addr_(addr), pkt_(std::move(pkt))
+udp_packet::udp_packet(SOCKET_T fd, const peer_t& addr, std::string&& pkt,
+  size_t segment_size, size_t gso_size)
+  : fd_(fd), source_addr_(addr), pkt_(std::move(pkt)),
+    segment_size_(segment_size), gso_size_(gso_size)
 { }
 
+/**
+ * @brief Factory, send by the given udp listener or connector
+*/
+std::shared_ptr<udp_outbox> udp_outbox::create(std::shared_ptr<inet_adapter> owner) {
+  return std::shared_ptr<udp_outbox>(new udp_outbox(owner));
+}
+
+udp_outbox::udp_outbox(std::shared_ptr<inet_adapter> owner) : owner_(owner) { }
+
+udp_outbox::~udp_outbox() { }
+
+/**
+ * @brief Queue a datagram to the peer
+*/
+bool udp_outbox::writeto(const peer_t& peer, const char* data, size_t length) {
+  if (owner_ == nullptr || SOCKET_NOT_VALIDATE(owner_->native_fd())) return false;
+  if (length == 0) return false;
+  outgoing_.push_back(outgoing_t{(struct sockaddr_in)peer, buffer_.size(), length});
+  buffer_.append(data, length);
+  // A full batch goes out at once, without waiting
+  if (outgoing_.size() - sent_ >= PECO_NET_UDP_BATCH_SIZE && !flushing_) {
+    ignore_result(this->send_batch_());
+  }
+  if (!scheduled_ && !flushing_ && this->pending() > 0) {
+    scheduled_ = true;
+    std::weak_ptr<udp_outbox> weak_self = this->shared_from_this();
+    loop::shared()->call_before_idle([weak_self]() {
+      if (auto self = weak_self.lock()) self->flush_on_idle_();
+    });
+  }
+  return true;
+}
+bool udp_outbox::writeto(const peer_t& peer, const std::string& data) {
+  return this->writeto(peer, data.c_str(), data.size());
+}
+
+/**
+ * @brief Send all queued datagrams now, invoke in a task. If another
+ * task is flushing, the datagrams will be sent by it
+*/
+bool udp_outbox::flush(duration_t timedout) {
+  if (owner_ == nullptr) return false;
+  if (flushing_) return true;
+  flushing_ = true;
+  // Keep alive while waiting for the socket
+  auto self = this->shared_from_this();
+  bool ok = true;
+  while (!this->send_batch_()) {
+    task::this_task().wait_fd_for_event(owner_->native_fd(), kEventTypeWrite, timedout);
+    if (task::this_task().signal() != kWaitingSignalReceived) {
+      // Datagrams can be lost anyway, drop the rest
+      ok = false;
+      outgoing_.clear();
+      buffer_.clear();
+      sent_ = 0;
+      break;
+    }
+  }
+  flushing_ = false;
+  return ok;
+}
+
+/**
+ * @brief Count of datagrams not sent yet
+*/
+size_t udp_outbox::pending() const {
+  return outgoing_.size() - sent_;
+}
+
+/**
+ * @brief Send queued datagrams until the socket buffer is full, return
+ * true if nothing is left
+*/
+bool udp_outbox::send_batch_() {
+  SOCKET_T fd = owner_->native_fd();
+#if PECO_TARGET_LINUX
+  // The socket's segment size would split each datagram, turn it off
+  // for every message
+  auto listener = std::dynamic_pointer_cast<udp_listener>(owner_);
+  bool no_segment = (listener != nullptr && listener->gso_size_ > 0);
+#endif
+  while (sent_ < outgoing_.size()) {
+#if PECO_TARGET_LINUX
+    struct mmsghdr msgs[PECO_NET_UDP_BATCH_SIZE];
+    struct iovec iovs[PECO_NET_UDP_BATCH_SIZE];
+    char controls[PECO_NET_UDP_BATCH_SIZE][CMSG_SPACE(sizeof(uint16_t))];
+    size_t count = std::min<size_t>(PECO_NET_UDP_BATCH_SIZE, outgoing_.size() - sent_);
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (size_t i = 0; i < count; ++i) {
+      auto& o = outgoing_[sent_ + i];
+      iovs[i].iov_base = (void *)(buffer_.c_str() + o.offset);
+      iovs[i].iov_len = o.length;
+      msgs[i].msg_hdr.msg_name = &o.addr;
+      msgs[i].msg_hdr.msg_namelen = sizeof(o.addr);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      if (no_segment) {
+        memset(controls[i], 0, sizeof(controls[i]));
+        msgs[i].msg_hdr.msg_control = controls[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+        auto cm = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        uint16_t segment = 0;
+        memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+      }
+    }
+    int ret = ::sendmmsg(fd, msgs, (unsigned int)count, 0 | SO_NETWORK_NOSIGNAL);
+#else
+    auto& o = outgoing_[sent_];
+    int ret = (int)::sendto(fd, buffer_.c_str() + o.offset, o.length, 0 | SO_NETWORK_NOSIGNAL,
+      (struct sockaddr *)&o.addr, sizeof(o.addr));
+    if (ret >= 0) ret = 1;
+#endif
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) return false;
+      // Only the first datagram failed, skip it
+      log::warning << "Failed to send datagram on socket(" << fd << "), "
+        << ::strerror(errno) << std::endl;
+      ret = 1;
+    }
+    sent_ += (size_t)ret;
+  }
+  outgoing_.clear();
+  buffer_.clear();
+  sent_ = 0;
+  return true;
+}
+
+/**
+ * @brief Send without waiting when the loop goes idle, leave the rest
+ * to a flushing task
+*/
+void udp_outbox::flush_on_idle_() {
+  scheduled_ = false;
+  if (flushing_ || this->pending() == 0) return;
+  if (this->send_batch_()) return;
+  // The socket buffer is full, wait for it in a task
+  std::weak_ptr<udp_outbox> weak_self = this->shared_from_this();
+  loop::shared()->run([weak_self]() {
+    if (auto self = weak_self.lock()) ignore_result(self->flush());
+  });
+}
+
 } // namespace peco
 
 // Push Chen
@@ -36,9 +36,25 @@ SOFTWARE.
 
 #include "net/adapter.h"
 #include "net/bind.h"
+#include <vector>
 
 namespace peco {
 
+#ifndef PECO_NET_UDP_BATCH_SIZE
+// Max datagrams received or sent by one syscall
+#define PECO_NET_UDP_BATCH_SIZE     64
+#endif
+
+#ifndef PECO_NET_UDP_SEGMENT_SIZE
+// Size of each datagram when a write is split
+#define PECO_NET_UDP_SEGMENT_SIZE   1500
+#endif
+
+#ifndef PECO_NET_UDP_PACKET_SIZE
+// Max size of a datagram received in batch, the rest is truncated
+#define PECO_NET_UDP_PACKET_SIZE    2048
+#endif
+
 class udp_connector : public connector_adapter {
 public:
   virtual ~udp_connector();
@@ -103,6 +119,12 @@ public:
   */
   const std::string& data() const;
 
+  /**
+   * @brief Size of each datagram coalesced into this packet by GRO, the
+   * last one may be shorter. 0 if the packet is a single datagram
+  */
+  size_t segment_size() const;
+
   /**
    * @brief Write data back to origin addr
   */
@@ -114,16 +136,43 @@ protected:
   /**
    * @brief Static create for udp_listener
   */
-  static std::shared_ptr<udp_packet> create(SOCKET_T fd, const peer_t& addr, std::string&& pkt);
+  static std::shared_ptr<udp_packet> create(
+    SOCKET_T fd, const peer_t& addr, std::string&& pkt,
+    size_t segment_size, size_t gso_size);
   /**
    * @brief Build a udp packet
   */
-  udp_packet(SOCKET_T fd, const peer_t& addr, std::string&& pkt);
+  udp_packet(SOCKET_T fd, const peer_t& addr, std::string&& pkt,
+    size_t segment_size, size_t gso_size);
 
 protected:
   SOCKET_T fd_;
   peer_t source_addr_;
   std::string pkt_;
+  size_t segment_size_;
+  // The listener's GSO segment size when the packet is created
+  size_t gso_size_;
+};
+
+/**
+ * @brief Datagram received in batch, the data lives in the listener's
+ * arena and is only valid until the batch slot returns
+*/
+struct udp_datagram {
+  /**
+   * @brief Source of the datagram
+  */
+  peer_t        peer;
+  /**
+   * @brief Payload of the datagram
+  */
+  const char*   data;
+  size_t        length;
+  /**
+   * @brief The datagram is longer than PECO_NET_UDP_PACKET_SIZE and has
+   * been cut to it. Only on Linux
+  */
+  bool          truncated;
 };
 
 class udp_listener : public listener_adapter, public std::enable_shared_from_this<udp_listener> {
@@ -150,12 +199,35 @@ public:
   */
   bool listen(std::function<void(std::shared_ptr<udp_packet>)> accept_slot);
 
+  /**
+   * @brief Listen on the binded socket in batch mode, each syscall receives
+   * up to PECO_NET_UDP_BATCH_SIZE datagrams into a reused arena, and the
+   * slot gets them all at once, without allocation per datagram. Not
+   * available with GRO, whose coalesced datagrams do not fit the arena
+  */
+  bool listen_batch(std::function<void(const udp_datagram* datagrams, size_t count)> batch_slot);
+
   /**
    * @brief Write data to specified peer
   */
   bool writeto(const peer_t& peer, const char* data, size_t length);
   bool writeto(const peer_t& peer, const std::string& data);
 
+  /**
+   * @brief Split writes into datagrams of <segment_size> in the kernel by
+   * UDP_SEGMENT, so up to 64 datagrams go out by one syscall. 0 to turn
+   * off. A udp_outbox on the socket still sends one datagram per writeto.
+   * Only on Linux
+  */
+  bool set_gso(size_t segment_size = PECO_NET_UDP_SEGMENT_SIZE);
+
+  /**
+   * @brief Let the kernel coalesce datagrams of the same flow by UDP_GRO,
+   * a packet in packet mode may then carry many datagrams, see
+   * udp_packet::segment_size. Not available in batch mode. Only on Linux
+  */
+  bool set_gro(bool enable);
+
 protected:
   /**
    * @brief Listen on the binded socket
@@ -173,6 +245,75 @@ protected:
   */
   peer_bind bind_slot_;
   bool listened_ = false;
+  bool batched_ = false;
+  size_t gso_size_ = 0;
+  bool gro_ = false;
+
+  friend class udp_outbox;
+};
+
+/**
+ * @brief Outgoing datagrams of a udp socket. Datagrams queued during a
+ * scheduler pass are sent by sendmmsg when the loop is about to wait
+ * for events, each writeto is one datagram, even if the owner has GSO on.
+*/
+class udp_outbox : public std::enable_shared_from_this<udp_outbox> {
+public:
+  /**
+   * @brief Factory, send by the given udp listener or connector
+  */
+  static std::shared_ptr<udp_outbox> create(std::shared_ptr<inet_adapter> owner);
+
+  ~udp_outbox();
+
+public:
+  /**
+   * @brief Queue a datagram to the peer
+  */
+  bool writeto(const peer_t& peer, const char* data, size_t length);
+  bool writeto(const peer_t& peer, const std::string& data);
+
+  /**
+   * @brief Send all queued datagrams now, invoke in a task. If another
+   * task is flushing, the datagrams will be sent by it
+  */
+  bool flush(duration_t timedout = PECO_TIME_S(10));
+
+  /**
+   * @brief Count of datagrams not sent yet
+  */
+  size_t pending() const;
+
+protected:
+  udp_outbox(std::shared_ptr<inet_adapter> owner);
+
+  /**
+   * @brief Send queued datagrams until the socket buffer is full, return
+   * true if nothing is left
+  */
+  bool send_batch_();
+
+  /**
+   * @brief Send without waiting when the loop goes idle, leave the rest
+   * to a flushing task
+  */
+  void flush_on_idle_();
+
+protected:
+  struct outgoing_t {
+    struct sockaddr_in    addr;
+    size_t                offset;
+    size_t                length;
+  };
+
+  std::shared_ptr<inet_adapter>   owner_;
+  // Payloads of all queued datagrams
+  std::string                     buffer_;
+  std::vector<outgoing_t>         outgoing_;
+  // The first datagram not sent yet
+  size_t                          sent_ = 0;
+  bool                            scheduled_ = false;
+  bool                            flushing_ = false;
 };
 
 } // namespace peco
@@ -119,6 +119,7 @@ bool uds_listener::listen(listener_adapter::slot_accept_t accept_slot) {
   loop::shared()->run([=]() {
     std::string task_name = "uds_listen:" + local_path_;
     task::this_task().set_name(task_name.c_str());
+    task::this_task().set_listener();
     while (true) {
       task::this_task().wait_fd_for_event(self->fd_, kEventTypeRead, PECO_TIME_S(1800));
       auto sig = task::this_task().signal();
@@ -126,7 +127,11 @@ bool uds_listener::listen(listener_adapter::slot_accept_t accept_slot) {
         // task cancelled
         return;
       }
-      if (sig == kWaitingSignalNothing) continue;
+      if (sig == kWaitingSignalNothing) {
+        // Only a deadline set on the listener itself ends it
+        if (task::this_task().is_deadline_exceeded()) return;
+        continue;
+      }
       while(true) {
         struct sockaddr in_addr;
         socklen_t in_len = 0;
@@ -299,6 +299,23 @@ bool reusable(SOCKET_T hSo, bool reusable) {
   }
   return _r;
 }
+// Let sockets bind the same address and share its connections
+bool reuseport(SOCKET_T hSo, bool reuseport) {
+  if (SOCKET_NOT_VALIDATE(hSo))
+    return false;
+#ifdef SO_REUSEPORT
+  int _reused = reuseport ? 1 : 0;
+  bool _r = setsockopt(hSo, SOL_SOCKET, SO_REUSEPORT, (const char *)&_reused,
+                       sizeof(int)) != -1;
+  if (!_r) {
+    log::warning << "Warning: cannot set the socket to reuse port." << std::endl;
+  }
+  return _r;
+#else
+  ignore_result(reuseport);
+  return false;
+#endif
+}
 
 // Make current socket keep alive
 bool keepalive(SOCKET_T hSo, bool keepalive) {
@@ -367,6 +384,48 @@ bool nodelay(SOCKET_T hSo, bool nodelay) {
   }
   return _r;
 }
+// Cork the tcp socket
+bool cork(SOCKET_T hSo, bool cork) {
+  if (SOCKET_NOT_VALIDATE(hSo))
+    return false;
+  if (socktype(hSo) != kSocketTypeTCP)
+    return false;
+  int _flag = cork ? 1 : 0;
+#if PECO_TARGET_LINUX
+  int _opt = TCP_CORK;
+#elif PECO_TARGET_APPLE
+  int _opt = TCP_NOPUSH;
+#else
+  int _opt = -1;
+#endif
+  if (_opt == -1) return false;
+  bool _r = (setsockopt(hSo, IPPROTO_TCP, _opt, (const char *)&_flag,
+                        sizeof(int)) != -1);
+  if (!_r) {
+    log::warning << "Warning: cannot cork the tcp socket" << std::endl;
+  }
+  return _r;
+}
+// Allow MSG_ZEROCOPY sends on the tcp socket
+bool zerocopy(SOCKET_T hSo, bool zerocopy) {
+  if (SOCKET_NOT_VALIDATE(hSo))
+    return false;
+  if (socktype(hSo) != kSocketTypeTCP)
+    return false;
+#if PECO_TARGET_LINUX
+  int _flag = zerocopy ? 1 : 0;
+  bool _r = (setsockopt(hSo, SOL_SOCKET, SO_ZEROCOPY, (const char *)&_flag,
+                        sizeof(int)) != -1);
+  if (!_r) {
+    log::warning << "Warning: cannot set the socket to be zero-copy"
+                 << std::endl;
+  }
+  return _r;
+#else
+  ignore_result(zerocopy);
+  return false;
+#endif
+}
 // Set the socket's buffer size
 bool buffersize(SOCKET_T hSo, uint32_t rmem, uint32_t wmem) {
   if (SOCKET_NOT_VALIDATE(hSo))
@@ -398,7 +457,9 @@ bool has_data_pending(SOCKET_T hSo) {
   } while (_ret < 0 && errno == EINTR);
   // Try to peek
   if (_ret <= 0) return false;
-  _ret = recv(hSo, NULL, 0, MSG_PEEK);
+  // Peek one byte, a zero-length peek always returns 0
+  char _c = 0;
+  _ret = recv(hSo, &_c, 1, MSG_PEEK);
   // If _ret < 0, means recv an error signal
   return (_ret > 0);
 }
@@ -52,6 +52,16 @@ typedef long SOCKET_T;
 #define CO_MAX_SO_EVENTS 25600
 #endif
 
+#if PECO_TARGET_LINUX
+// Zero-copy sends, older headers may not have them
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY                 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY                0x4000000
+#endif
+#endif
+
 enum SocketType {
   /**
    * @brief TCP Socket
@@ -153,6 +163,12 @@ namespace net_utils {
   */
   bool reusable(SOCKET_T hSo, bool reusable = true);
 
+  /**
+   * @brief Let sockets bind the same address and share its connections,
+   * SO_REUSEPORT, set it before binding
+  */
+  bool reuseport(SOCKET_T hSo, bool reuseport = true);
+
   /**
    * @brief Make current socket keep alive
   */
@@ -168,6 +184,17 @@ namespace net_utils {
   */
   bool nodelay(SOCKET_T hSo, bool nodelay = true);
 
+  /**
+   * @brief Cork the tcp socket, partial segments are held by the kernel
+   * until uncorked. TCP_CORK on Linux and TCP_NOPUSH on Apple
+  */
+  bool cork(SOCKET_T hSo, bool cork = true);
+
+  /**
+   * @brief Allow MSG_ZEROCOPY sends on the tcp socket, only on Linux
+  */
+  bool zerocopy(SOCKET_T hSo, bool zerocopy = true);
+
   /**
    * @brief Set the socket's buffer size
   */
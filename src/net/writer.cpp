@@ -0,0 +1,155 @@
+/*
+    writer.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "net/writer.h"
+#include "task.h"
+
+#include <algorithm>
+
+namespace peco {
+
+/**
+ * @brief Factory
+*/
+std::shared_ptr<buffered_writer> buffered_writer::create(
+  std::shared_ptr<connector_adapter> conn, size_t threshold
+) {
+  return std::shared_ptr<buffered_writer>(new buffered_writer(conn, threshold));
+}
+
+buffered_writer::buffered_writer(std::shared_ptr<connector_adapter> conn, size_t threshold)
+  : conn_(conn), threshold_(threshold) { }
+
+buffered_writer::~buffered_writer() { }
+
+/**
+ * @brief Append data to the buffer, flush and wait if it reaches the
+ * threshold, invoke in a task. Return false if the connector is broken
+*/
+bool buffered_writer::write(const char* data, size_t length) {
+  if (broken_ || conn_ == nullptr) return false;
+  buffer_.append(data, length);
+  if (buffer_.size() >= threshold_) {
+    return this->flush();
+  }
+  if (!scheduled_ && !flushing_) {
+    scheduled_ = true;
+    std::weak_ptr<buffered_writer> weak_self = this->shared_from_this();
+    loop::shared()->call_before_idle([weak_self]() {
+      if (auto self = weak_self.lock()) self->flush_on_idle_();
+    });
+  }
+  return true;
+}
+bool buffered_writer::write(const std::string& data) {
+  return this->write(data.c_str(), data.size());
+}
+
+/**
+ * @brief Flush all buffered data now, invoke in a task. If another task
+ * is flushing, wait for it to send the data. Return false if the
+ * connector is broken or the data is not sent in time
+*/
+bool buffered_writer::flush(duration_t timedout) {
+  if (broken_ || conn_ == nullptr) return false;
+  // Keep alive while waiting for the socket
+  auto self = this->shared_from_this();
+  if (flushing_) {
+    // The flushing task sends until the buffer is empty, our data too
+    auto tid = task::this_task().task_id();
+    flush_waiters_.push_back(tid);
+    if (!task::this_task().holding_until(timedout)) {
+      flush_waiters_.erase(std::remove(flush_waiters_.begin(), flush_waiters_.end(), tid),
+        flush_waiters_.end());
+      return false;
+    }
+    return !broken_;
+  }
+  flushing_ = true;
+  // Hold partial segments until all buffered data is in the kernel,
+  // only when it may take more than one send
+  bool corked = (buffer_.size() >= threshold_ && conn_->set_cork(true));
+  while (buffer_.size() > 0) {
+    // New data written while sending goes into the other buffer
+    sending_.swap(buffer_);
+    if (!conn_->write(sending_.c_str(), sending_.size(), timedout)) {
+      broken_ = true;
+      buffer_.clear();
+    }
+    sending_.clear();
+  }
+  if (corked) conn_->set_cork(false);
+  flushing_ = false;
+  std::vector<task_id_t> waiters;
+  waiters.swap(flush_waiters_);
+  for (auto tid : waiters) task(tid).wakeup();
+  return !broken_;
+}
+
+/**
+ * @brief Size of data not sent yet
+*/
+size_t buffered_writer::pending() const {
+  return buffer_.size();
+}
+
+/**
+ * @brief Get the connector
+*/
+std::shared_ptr<connector_adapter> buffered_writer::connector() const {
+  return conn_;
+}
+
+/**
+ * @brief Send without waiting when the loop goes idle, leave the rest
+ * to a flushing task
+*/
+void buffered_writer::flush_on_idle_() {
+  scheduled_ = false;
+  if (broken_ || flushing_ || buffer_.size() == 0) return;
+  auto sent = conn_->try_write(buffer_.c_str(), buffer_.size());
+  if (sent < 0) {
+    broken_ = true;
+    buffer_.clear();
+    return;
+  }
+  buffer_.erase(0, (size_t)sent);
+  if (buffer_.size() == 0) return;
+  // The socket buffer is full, wait for it in a task
+  std::weak_ptr<buffered_writer> weak_self = this->shared_from_this();
+  loop::shared()->run([weak_self]() {
+    if (auto self = weak_self.lock()) ignore_result(self->flush());
+  });
+}
+
+} // namespace peco
+
+// Push Chen
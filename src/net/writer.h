@@ -0,0 +1,117 @@
+/*
+    writer.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_NET_WRITER_H__
+#define PECO_NET_WRITER_H__
+
+#include "net/adapter.h"
+
+#include <vector>
+
+namespace peco {
+
+#ifndef PECO_NET_WRITER_THRESHOLD
+// Buffered data reaching this size is flushed at once
+#define PECO_NET_WRITER_THRESHOLD   65536   // 64KB
+#endif
+
+/**
+ * @brief Buffered output stream of a connector. Writes made during a
+ * scheduler pass are gathered and sent by one syscall when the loop is
+ * about to wait for events, or at once when the buffer reaches the
+ * threshold. A write reaching the threshold waits until the data is sent,
+ * so a slow peer holds back the writers instead of growing the buffer.
+ * Do not mix with the connector's own write.
+*/
+class buffered_writer : public std::enable_shared_from_this<buffered_writer> {
+public:
+  /**
+   * @brief Factory
+  */
+  static std::shared_ptr<buffered_writer> create(
+    std::shared_ptr<connector_adapter> conn,
+    size_t threshold = PECO_NET_WRITER_THRESHOLD);
+
+  ~buffered_writer();
+
+public:
+  /**
+   * @brief Append data to the buffer, flush and wait if it reaches the
+   * threshold, invoke in a task. Return false if the connector is broken
+  */
+  bool write(const char* data, size_t length);
+  bool write(const std::string& data);
+
+  /**
+   * @brief Flush all buffered data now, invoke in a task. If another task
+   * is flushing, wait for it to send the data. Return false if the
+   * connector is broken or the data is not sent in time
+  */
+  bool flush(duration_t timedout = PECO_TIME_S(10));
+
+  /**
+   * @brief Size of data not sent yet
+  */
+  size_t pending() const;
+
+  /**
+   * @brief Get the connector
+  */
+  std::shared_ptr<connector_adapter> connector() const;
+
+protected:
+  buffered_writer(std::shared_ptr<connector_adapter> conn, size_t threshold);
+
+  /**
+   * @brief Send without waiting when the loop goes idle, leave the rest
+   * to a flushing task
+  */
+  void flush_on_idle_();
+
+protected:
+  std::shared_ptr<connector_adapter>  conn_;
+  size_t                              threshold_;
+  std::string                         buffer_;
+  std::string                         sending_;
+  // Tasks waiting for the flushing task
+  std::vector<task_id_t>              flush_waiters_;
+  bool                                scheduled_ = false;
+  bool                                flushing_ = false;
+  bool                                broken_ = false;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
@@ -36,14 +36,18 @@ SOFTWARE.
 
 #include "task/taskdef.h"
 #include "task/task.h"
+#include "task/timer.h"
 #include "task/loop.h"
 #include "task/semaphore.h"
 #include "task/signal.h"
+#include "task/taskgroup.h"
+#include "task/tasklocal.h"
 
 #if PECO_ENABLE_SHARETASK
 #include "task/shared/loop.h"
 #include "task/shared/injector.h"
 #include "task/shared/task.h"
+#include "task/shared/loopgroup.h"
 #endif
 
 #endif
@@ -35,6 +35,7 @@ SOFTWARE.
 #include <sys/event.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <signal.h>
 
 typedef struct kevent core_event_t;
 
@@ -44,26 +45,42 @@ typedef struct kevent core_event_t;
 
 namespace peco {
 /**
- * @brief Init the core fd(if any) and bind the error and event handler
+ * @brief Init the core fd(if any) and bind the error, event and signal handler
  */
 void loopcore::init(loopcore::core_error_handler_t herr,
-                    loopcore::core_event_handler_t hevent
+                    loopcore::core_event_handler_t hevent,
+                    loopcore::core_signal_handler_t hsignal
                     ) 
 {
   on_error_ = herr;
   on_event_ = hevent;
+  on_signal_ = hsignal;
 
   signal(SIGPIPE, SIG_IGN);
 
   // Create kqueue core fd
   core_fd_ = kqueue();
   core_vars_ = calloc(CO_MAX_SO_EVENTS, sizeof(core_event_t));
+
+  // Signals added before the loop starts
+  for (int signo = 1; signo <= 64; ++signo) {
+    if (!(signal_mask_ & (1ull << (signo - 1)))) continue;
+    core_event_t e;
+    EV_SET(&e, signo, EVFILT_SIGNAL, EV_ADD, 0, 0, NULL);
+    ignore_result(kevent(core_fd_, &e, 1, NULL, 0, NULL));
+  }
+  // The interrupt fd set before the loop starts
+  if (interrupt_fd_ != -1) {
+    core_event_t e;
+    EV_SET(&e, interrupt_fd_, EVFILT_READ, EV_ADD, 0, 0, NULL);
+    ignore_result(kevent(core_fd_, &e, 1, NULL, 0, NULL));
+  }
 }
 
 /**
- * @brief Block and wait for all fd
+ * @brief Block and wait for all fd, return the count of events, -1 on error
  */
-void loopcore::wait(duration_t duration) {
+int loopcore::wait(duration_t duration) {
   static const auto kNanoToSeconds = (1000 * 1000 * 1000);
   auto nano = duration.count();
   struct timespec ts = {nano / kNanoToSeconds, nano % kNanoToSeconds};
@@ -73,12 +90,23 @@ void loopcore::wait(duration_t duration) {
   time_waited_ += (TASK_TIME_NOW() - begin).count();
   
   // Already stopped
-  if (count == -1) return;
+  if (count == -1) return -1;
 
   for (int i = 0; i < count; ++i) {
     core_event_t* process_event = reinterpret_cast<core_event_t*>(core_vars_) + i;
     long fd = process_event->ident;
 
+    // kqueue reports signals by the signal filter
+    if (process_event->filter == EVFILT_SIGNAL) {
+      if (on_signal_) on_signal_((int)fd);
+      continue;
+    }
+    // The interrupt fd keeps readable, nothing to read
+    if (process_event->filter == EVFILT_READ && fd == interrupt_fd_) {
+      interrupted_ = true;
+      continue;
+    }
+
     auto flags = process_event->flags;
     if ((flags & EV_EOF) || (flags & EV_ERROR)) {
       if (on_error_) on_error_(fd);
@@ -91,6 +119,7 @@ void loopcore::wait(duration_t duration) {
         on_event_(fd, etype);
     }
   }
+  return count;
 }
 
 /**s
@@ -136,6 +165,65 @@ void loopcore::del_write_event(long fd) {
   ignore_result(kevent(core_fd_, &e, 1, NULL, 0, NULL));
 }
 
+/**
+ * @brief Process the error queue event, kqueue has no error queue
+*/
+bool loopcore::add_error_event(long fd) {
+  ignore_result(fd);
+  return false;
+}
+void loopcore::del_error_event(long fd) {
+  ignore_result(fd);
+}
+
+/**
+ * @brief Receive the signal in the core instead of the default action
+*/
+bool loopcore::add_signal(int signo) {
+  if (signo < 1 || signo > 64) return false;
+  // kqueue records the signal even if it is ignored, but never sees
+  // a blocked one, so just drop the default action
+  signal(signo, SIG_IGN);
+  signal_mask_ |= (1ull << (signo - 1));
+  if (core_fd_ != -1) {
+    core_event_t e;
+    EV_SET(&e, signo, EVFILT_SIGNAL, EV_ADD, 0, 0, NULL);
+    return (-1 != kevent(core_fd_, &e, 1, NULL, 0, NULL));
+  }
+  return true;
+}
+void loopcore::del_signal(int signo) {
+  if (signo < 1 || signo > 64) return;
+  if (!(signal_mask_ & (1ull << (signo - 1)))) return;
+  signal_mask_ &= ~(1ull << (signo - 1));
+  if (core_fd_ != -1) {
+    core_event_t e;
+    EV_SET(&e, signo, EVFILT_SIGNAL, EV_DELETE, 0, 0, NULL);
+    ignore_result(kevent(core_fd_, &e, 1, NULL, 0, NULL));
+  }
+  signal(signo, SIG_DFL);
+}
+
+/**
+ * @brief Watch the fd written by other threads to interrupt the loop,
+ * the fd is owned by the caller
+ */
+void loopcore::set_interrupt_fd(long fd) {
+  interrupt_fd_ = fd;
+  if (core_fd_ != -1) {
+    core_event_t e;
+    EV_SET(&e, interrupt_fd_, EVFILT_READ, EV_ADD, 0, 0, NULL);
+    ignore_result(kevent(core_fd_, &e, 1, NULL, 0, NULL));
+  }
+}
+
+/**
+ * @brief Tell if the interrupt fd has become readable
+ */
+bool loopcore::interrupted() const {
+  return interrupted_;
+}
+
 /**
  * @brief Get all time cost on waiting
 */
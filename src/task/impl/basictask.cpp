@@ -32,6 +32,8 @@ SOFTWARE.
 #include "task/impl/basictask.hxx"
 
 #include <unordered_map>
+#include <mutex>
+#include <signal.h>
 
 namespace peco {
 
@@ -67,6 +69,16 @@ void __context_main__(void * ptask) {
 
 typedef std::shared_ptr<basic_task> basic_task_ptr_t;
 
+/**
+ * @brief Make the task and its shared count in one allocation
+*/
+struct __basic_task_maker : public basic_task {
+  __basic_task_maker(
+    stack_cache::task_buffer_ptr buffer, worker_t&& worker,
+    repeat_count_t repeat_count, duration_t interval)
+    : basic_task(std::move(buffer), std::move(worker), repeat_count, interval) { }
+};
+
 /**
  * @brief Task Cache
 */
@@ -75,16 +87,38 @@ std::unordered_map<task_id_t, basic_task_ptr_t>& get_task_cache() {
   return g_cache;
 }
 
+/**
+ * @brief Task local slot info, shared by all tasks in all threads
+*/
+struct local_slot_info_t {
+  size_t                            offset;
+  size_t                            size;
+  bool                              boxed;
+  basic_task::local_destructor_t    dtor;
+};
+local_slot_info_t g_local_slots[kMaxTaskLocalCount];
+size_t g_local_slot_count = 0;
+size_t g_local_used_size = 0;
+std::mutex g_local_slot_lock;
+
 /**
  * @brief Create a task with worker
 */
 basic_task::basic_task(worker_t worker, repeat_count_t repeat_count, duration_t interval)
-  : buffer_(stack_cache::fetch()) {
+  : basic_task(stack_cache::fetch(), std::move(worker), repeat_count, interval) { }
+
+/**
+ * @brief Create a task with worker on the given stack buffer
+*/
+basic_task::basic_task(
+  stack_cache::task_buffer_ptr buffer, worker_t&& worker,
+  repeat_count_t repeat_count, duration_t interval)
+  : buffer_(std::move(buffer)) {
   task_ = new (buffer_->buf) task_context_t;
   // Task id is the address of the buffer
   task_->tid = (task_id_t)(&buffer_->buf);
   // Set worker
-  task_->worker = worker;
+  task_->worker = std::move(worker);
   task_->repeat_count = repeat_count;
   task_->interval = interval;
   // Set stack
@@ -95,20 +129,34 @@ basic_task::basic_task(worker_t worker, repeat_count_t repeat_count, duration_t
   task_->status = kTaskStatusPending;
   task_->cancelled = false;
   task_->next_fire_time = TASK_TIME_NOW() + interval;
+  task_->priority = kTaskPriorityNormal;
+  task_->ready = false;
+  task_->listener = false;
+  task_->ready_next = nullptr;
+  task_->heap_index = HEAP_INDEX_INVALID;
+  task_->wait_fd = -1l;
+  task_->wait_event = kEventTypeRead;
+  task_->wait_prev = nullptr;
+  task_->wait_next = nullptr;
+  task_->last_run_time = task_time_t::min();
+  task_->stack_at_suspend = 0;
 
   // Extra
   extra_ = reinterpret_cast<task_extra_t *>(buffer_->buf + (size_t)kTaskContextSize);
   extra_->zero1 = 0;
   extra_->name[0] = '\0';
   extra_->arg = nullptr;
+  memset(extra_->local_mask, 0, sizeof(extra_->local_mask));
   auto r = basic_task::running_task();
   if (r) {
     extra_->parent_tid = r->task_id();
+    task_->deadline = r->deadline();
   } else {
     extra_->parent_tid = kInvalidateTaskId;
+    task_->deadline = task_time_t::max();
   }
-
-  this->reset_task();
+  // The stack context will be built before the first switch, so
+  // creating a task which is never run costs nothing
 }
 
 /**
@@ -119,6 +167,10 @@ basic_task::~basic_task() {
     task_->atexit();
     task_->atexit = nullptr;
   }
+  this->reset_all_locals_();
+  if (snapshot_) {
+    snapshot_->publish(kTaskStatusStopped, task_->signal, task_->cancelled);
+  }
   task_->worker = nullptr;
   stack_cache::release(buffer_);
 }
@@ -129,11 +181,33 @@ basic_task::~basic_task() {
 std::shared_ptr<basic_task> basic_task::create_task(
   worker_t worker, repeat_count_t repeat_count, duration_t interval) {
 
-  auto ptr = std::shared_ptr<basic_task>(new basic_task(worker, repeat_count, interval));
+  basic_task_ptr_t ptr = std::make_shared<__basic_task_maker>(
+    stack_cache::fetch(), std::move(worker), repeat_count, interval);
   get_task_cache()[ptr->task_id()] = ptr;
   return ptr;
 }
 
+/**
+ * @brief Create oneshot tasks for all workers at once, stacks and
+ * cache slots are reserved in bulk
+*/
+std::vector<std::shared_ptr<basic_task>> basic_task::create_tasks(
+  std::vector<worker_t>&& workers) {
+  std::vector<stack_cache::task_buffer_ptr> buffers;
+  stack_cache::fetch(workers.size(), buffers);
+  auto& cache = get_task_cache();
+  cache.reserve(cache.size() + workers.size());
+  std::vector<std::shared_ptr<basic_task>> tasks;
+  tasks.reserve(workers.size());
+  for (size_t i = 0; i < workers.size(); ++i) {
+    basic_task_ptr_t ptr = std::make_shared<__basic_task_maker>(
+      std::move(buffers[i]), std::move(workers[i]), REPEAT_COUNT_ONESHOT, PECO_TIME_MS(0));
+    cache.emplace(ptr->task_id(), ptr);
+    tasks.emplace_back(std::move(ptr));
+  }
+  return tasks;
+}
+
 /**
  * @brief Destroy this task, will remove from global cache
 */
@@ -178,9 +252,14 @@ void basic_task::swap_to_task() {
   if (task_->status == kTaskStatusStopped) {
     return;
   }
+  if (!context_ready_) {
+    this->reset_task();
+    context_ready_ = true;
+  }
   // Update running task
   basic_task::running_task() = this->shared_from_this();
   task_->status = kTaskStatusRunning;
+  this->publish_snapshot();
 
 #if PECO_TARGET_APPLE
   if (!setjmp(*get_main_context())) {
@@ -199,14 +278,37 @@ void basic_task::swap_to_task() {
   if (task_->status == kTaskStatusRunning) {
     if (task_->repeat_count == 1 || task_->cancelled) {
       task_->status = kTaskStatusStopped;
-      return;
+    } else {
+      if (task_->repeat_count != REPEAT_COUNT_INFINITIVE) {
+        --task_->repeat_count;
+      }
+      task_->next_fire_time += task_->interval;
+      this->reset_task();
+      task_->status = kTaskStatusPending;
     }
-    if (task_->repeat_count != REPEAT_COUNT_INFINITIVE) {
-      --task_->repeat_count;
-    }
-    task_->next_fire_time += task_->interval;
-    this->reset_task();
-    task_->status = kTaskStatusPending;
+  }
+  this->publish_snapshot();
+}
+
+/**
+ * @brief Get the cross-thread snapshot of this task, if <create> is true,
+ * create it at the first call
+*/
+std::shared_ptr<task_snapshot> basic_task::snapshot(bool create) {
+  if (!snapshot_ && create) {
+    snapshot_ = std::make_shared<task_snapshot>();
+    snapshot_->publish_name(extra_->name);
+    this->publish_snapshot();
+  }
+  return snapshot_;
+}
+
+/**
+ * @brief Publish current state to the snapshot if any
+*/
+void basic_task::publish_snapshot() {
+  if (snapshot_) {
+    snapshot_->publish(task_->status, task_->signal, task_->cancelled);
   }
 }
 
@@ -229,6 +331,11 @@ std::shared_ptr<basic_task>& basic_task::running_task() {
  * @brief Swap to main context
 */
 void basic_task::swap_to_main() {
+  basic_task* rt = basic_task::running_task().get();
+  // Sample the stack depth at every suspension point, the stack grows
+  // down from the end of the buffer
+  size_t depth = (size_t)(rt->buffer_->buf + TASK_STACK_SIZE - (char *)&rt);
+  if (depth > rt->task_->stack_at_suspend) rt->task_->stack_at_suspend = depth;
 #if PECO_TARGET_APPLE
   if (!setjmp(basic_task::running_task()->task_->ctx)) {
     longjmp(*get_main_context(), 1);
@@ -324,6 +431,9 @@ void basic_task::set_name(const char* name) {
   if (cl < kTaskNameLength) {
     extra_->name[cl] = '\0';
   }
+  if (snapshot_) {
+    snapshot_->publish_name(extra_->name);
+  }
 }
 
 /**
@@ -340,6 +450,154 @@ task_id_t basic_task::parent_task() const {
   return extra_->parent_tid;
 }
 
+/**
+ * @brief Set the task's priority class
+*/
+void basic_task::set_priority(TaskPriority priority) {
+  if ((size_t)priority >= kTaskPriorityCount) return;
+  task_->priority = priority;
+}
+
+/**
+ * @brief Get the task's priority class
+*/
+TaskPriority basic_task::priority() const {
+  return task_->priority;
+}
+
+/**
+ * @brief Mark the task as a listener which accepts new work, a listener
+ * outlives any request, so the inherited deadline is dropped
+*/
+void basic_task::set_listener(bool listener) {
+  task_->listener = listener;
+  if (listener) task_->deadline = task_time_t::max();
+}
+
+/**
+ * @brief Tell if the task is a listener
+*/
+bool basic_task::is_listener() const {
+  return task_->listener;
+}
+
+/**
+ * @brief Set the deadline of the task
+*/
+void basic_task::set_deadline(task_time_t deadline) {
+  task_->deadline = deadline;
+}
+
+/**
+ * @brief Get the deadline of the task
+*/
+task_time_t basic_task::deadline() const {
+  return task_->deadline;
+}
+
+/**
+ * @brief Tell if the task's deadline has passed
+*/
+bool basic_task::deadline_exceeded() const {
+  if (task_->deadline == task_time_t::max()) return false;
+  return TASK_TIME_NOW() >= task_->deadline;
+}
+
+/**
+ * @brief Clamp the timeout to the task's deadline
+*/
+duration_t basic_task::clamp_to_deadline(duration_t timedout) const {
+  if (task_->deadline == task_time_t::max()) return timedout;
+  auto now = TASK_TIME_NOW();
+  if (now >= task_->deadline) return duration_t::zero();
+  return std::min(timedout, duration_t(task_->deadline - now));
+}
+
+/**
+ * @brief Register a task local slot for all tasks,
+ * return kMaxTaskLocalCount if there is no more slot
+*/
+size_t basic_task::alloc_local_slot(size_t size, size_t align, local_destructor_t dtor) {
+  std::lock_guard<std::mutex> _(g_local_slot_lock);
+  if (g_local_slot_count == kMaxTaskLocalCount) return kMaxTaskLocalCount;
+  auto& info = g_local_slots[g_local_slot_count];
+  info.size = size;
+  info.dtor = dtor;
+  size_t offset = (align == 0 ? g_local_used_size : ((g_local_used_size + align - 1) / align) * align);
+  if (align <= 16 && offset + size <= (size_t)kTaskLocalSize) {
+    info.offset = offset;
+    info.boxed = false;
+  } else {
+    // No more reserved space, only keep a pointer in the slot,
+    // and the value will be allocated on heap
+    offset = ((g_local_used_size + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *);
+    if (offset + sizeof(void *) > (size_t)kTaskLocalSize) return kMaxTaskLocalCount;
+    info.offset = offset;
+    info.boxed = true;
+    size = sizeof(void *);
+  }
+  g_local_used_size = offset + size;
+  return g_local_slot_count++;
+}
+
+/**
+ * @brief Get the value of given local slot, if the value has not been
+ * constructed, use <ctor> to construct it. If <ctor> is null, return nullptr
+*/
+void* basic_task::local_value(size_t slot, local_constructor_t ctor) {
+  if (slot >= kMaxTaskLocalCount) return nullptr;
+  const auto& info = g_local_slots[slot];
+  char* storage = buffer_->buf + (size_t)kTaskLocalOffset + info.offset;
+  uint64_t bit = (1llu << (slot % 64));
+  uint64_t& mask = extra_->local_mask[slot / 64];
+  if (mask & bit) {
+    return (info.boxed ? *reinterpret_cast<void **>(storage) : storage);
+  }
+  if (ctor == nullptr) return nullptr;
+  void* value = storage;
+  if (info.boxed) {
+    value = ::operator new(info.size);
+    *reinterpret_cast<void **>(storage) = value;
+  }
+  ctor(value);
+  mask |= bit;
+  return value;
+}
+
+/**
+ * @brief Destroy the value of given local slot
+*/
+void basic_task::reset_local(size_t slot) {
+  if (slot >= kMaxTaskLocalCount) return;
+  uint64_t bit = (1llu << (slot % 64));
+  uint64_t& mask = extra_->local_mask[slot / 64];
+  if (!(mask & bit)) return;
+  const auto& info = g_local_slots[slot];
+  char* storage = buffer_->buf + (size_t)kTaskLocalOffset + info.offset;
+  // Unmark first, in case the destructor access this slot again
+  mask &= ~bit;
+  if (info.boxed) {
+    void* value = *reinterpret_cast<void **>(storage);
+    info.dtor(value);
+    ::operator delete(value);
+  } else {
+    info.dtor(storage);
+  }
+}
+
+/**
+ * @brief Destroy all constructed local values
+*/
+void basic_task::reset_all_locals_() {
+  for (size_t i = 0; i < sizeof(extra_->local_mask) / sizeof(uint64_t); ++i) {
+    while (extra_->local_mask[i] != 0) {
+      size_t bit_index = 0;
+      while (!(extra_->local_mask[i] & (1llu << bit_index))) ++bit_index;
+      this->reset_local(i * 64 + bit_index);
+    }
+  }
+}
+
 /**
  * @brief Fetch the created task by its id
 */
@@ -358,6 +616,29 @@ size_t basic_task::cache_size() {
   return get_task_cache().size();
 }
 
+/**
+ * @brief Block or unblock the signal in the main context and all saved
+ * task contexts, switching context restores the saved signal mask
+*/
+void basic_task::set_signal_blocked(int signo, bool blocked) {
+#if !PECO_TARGET_APPLE && !PECO_TARGET_WIN
+  auto update = [signo, blocked](stack_context_t* ctx) {
+    if (blocked) {
+      sigaddset(&ctx->uc_sigmask, signo);
+    } else {
+      sigdelset(&ctx->uc_sigmask, signo);
+    }
+  };
+  update(get_main_context());
+  for (const auto& item : get_task_cache()) {
+    update(&item.second->task_->ctx);
+  }
+#else
+  ignore_result(signo);
+  ignore_result(blocked);
+#endif
+}
+
 /**
  * @brief Scan all cached task
 */
@@ -36,6 +36,7 @@ SOFTWARE.
 
 #include "task/impl/taskcontext.hxx"
 #include "task/impl/stackcache.hxx"
+#include "task/impl/tasksnapshot.hxx"
 
 namespace peco {
 
@@ -44,7 +45,9 @@ public:
   enum {
     kMaxFlagCount = 16
   };
-private:
+  typedef void (*local_constructor_t)(void*);
+  typedef void (*local_destructor_t)(void*);
+protected:
   /**
    * @brief Create a task with worker
   */
@@ -52,6 +55,13 @@ private:
     worker_t worker, repeat_count_t repeat_count = REPEAT_COUNT_ONESHOT, 
     duration_t interval = PECO_TIME_MS(0));
 
+  /**
+   * @brief Create a task with worker on the given stack buffer
+  */
+  basic_task(
+    stack_cache::task_buffer_ptr buffer, worker_t&& worker,
+    repeat_count_t repeat_count, duration_t interval);
+
 public:
   /**
    * @brief force to create a shared ptr task
@@ -60,6 +70,13 @@ public:
     worker_t worker, repeat_count_t repeat_count = REPEAT_COUNT_ONESHOT, 
     duration_t interval = PECO_TIME_MS(0));
 
+  /**
+   * @brief Create oneshot tasks for all workers at once, stacks and
+   * cache slots are reserved in bulk
+  */
+  static std::vector<std::shared_ptr<basic_task>> create_tasks(
+    std::vector<worker_t>&& workers);
+
 public:
   /**
    * @brief Release the task, and invoke `atexit`
@@ -132,6 +149,64 @@ public:
   */
   task_id_t parent_task() const;
 
+  /**
+   * @brief Set the task's priority class
+  */
+  void set_priority(TaskPriority priority);
+
+  /**
+   * @brief Get the task's priority class
+  */
+  TaskPriority priority() const;
+
+  /**
+   * @brief Mark the task as a listener which accepts new work, a listener
+   * outlives any request, so the inherited deadline is dropped
+  */
+  void set_listener(bool listener);
+
+  /**
+   * @brief Tell if the task is a listener
+  */
+  bool is_listener() const;
+
+  /**
+   * @brief Set the deadline of the task
+  */
+  void set_deadline(task_time_t deadline);
+
+  /**
+   * @brief Get the deadline of the task
+  */
+  task_time_t deadline() const;
+
+  /**
+   * @brief Tell if the task's deadline has passed
+  */
+  bool deadline_exceeded() const;
+
+  /**
+   * @brief Clamp the timeout to the task's deadline
+  */
+  duration_t clamp_to_deadline(duration_t timedout) const;
+
+  /**
+   * @brief Register a task local slot for all tasks,
+   * return kMaxTaskLocalCount if there is no more slot
+  */
+  static size_t alloc_local_slot(size_t size, size_t align, local_destructor_t dtor);
+
+  /**
+   * @brief Get the value of given local slot, if the value has not been
+   * constructed, use <ctor> to construct it. If <ctor> is null, return nullptr
+  */
+  void* local_value(size_t slot, local_constructor_t ctor);
+
+  /**
+   * @brief Destroy the value of given local slot
+  */
+  void reset_local(size_t slot);
+
   /**
    * @brief Reset the task's status and ready for another loop
    * Only use this method in repeatable task
@@ -148,6 +223,17 @@ public:
   */
   void update_interval(duration_t interval);
 
+  /**
+   * @brief Get the cross-thread snapshot of this task, if <create> is true,
+   * create it at the first call
+  */
+  std::shared_ptr<task_snapshot> snapshot(bool create = true);
+
+  /**
+   * @brief Publish current state to the snapshot if any
+  */
+  void publish_snapshot();
+
   /**
    * @brief Swap to current task
   */
@@ -177,10 +263,25 @@ public:
    * @brief Get the cache task count
   */
   static size_t cache_size();
+
+  /**
+   * @brief Block or unblock the signal in the main context and all saved
+   * task contexts, switching context restores the saved signal mask
+  */
+  static void set_signal_blocked(int signo, bool blocked);
+protected:
+  /**
+   * @brief Destroy all constructed local values
+  */
+  void reset_all_locals_();
+
 protected:
   stack_cache::task_buffer_ptr    buffer_;
   task_context_t*                 task_;
   task_extra_t*                   extra_;
+  std::shared_ptr<task_snapshot>  snapshot_;
+  // The stack context is built right before the first switch
+  bool                            context_ready_ = false;
 };
 
 } // namespace peco
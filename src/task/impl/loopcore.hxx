@@ -44,17 +44,19 @@ class loopcore {
 public:
   typedef std::function<void(long)> core_error_handler_t;
   typedef std::function<void(long, EventType)> core_event_handler_t; 
+  typedef std::function<void(int)> core_signal_handler_t;
 
 public :
   /**
-   * @brief Init the core fd(if any) and bind the error and event handler
+   * @brief Init the core fd(if any) and bind the error, event and signal handler
    */
-  void init(core_error_handler_t herr, core_event_handler_t hevent);
+  void init(core_error_handler_t herr, core_event_handler_t hevent,
+    core_signal_handler_t hsignal = nullptr);
 
   /**
-   * @brief Block and wait for all fd
+   * @brief Block and wait for all fd, return the count of events, -1 on error
   */
-  void wait(duration_t duration);
+  int wait(duration_t duration);
 
   /**
    * @brief Break the waiting
@@ -73,6 +75,30 @@ public :
   bool add_write_event(long fd);
   void del_write_event(long fd);
 
+  /**
+   * @brief Process the error queue event, once added the error queue
+   * messages are not taken as a broken fd until deleted
+  */
+  bool add_error_event(long fd);
+  void del_error_event(long fd);
+
+  /**
+   * @brief Receive the signal in the core instead of the default action
+  */
+  bool add_signal(int signo);
+  void del_signal(int signo);
+
+  /**
+   * @brief Watch the fd written by other threads to interrupt the loop,
+   * the fd is owned by the caller
+  */
+  void set_interrupt_fd(long fd);
+
+  /**
+   * @brief Tell if the interrupt fd has become readable
+  */
+  bool interrupted() const;
+
   /**
    * @brief Get all time cost on waiting
   */
@@ -84,12 +110,18 @@ protected:
   // Any platform related data  
   any core_data_;
   uint64_t time_waited_ = 0;
+  // Bitmask of the received signals, bit (signo - 1)
+  uint64_t signal_mask_ = 0;
+  long signal_fd_ = -1;
+  long interrupt_fd_ = -1;
+  bool interrupted_ = false;
 
   /**
    * @brief Event Handlers
   */
   core_error_handler_t on_error_;
   core_event_handler_t on_event_;
+  core_signal_handler_t on_signal_;
 };
 } // namespace peco
 
@@ -30,6 +30,11 @@ SOFTWARE.
 */
 
 #include "task/impl/loopimpl.hxx"
+#include "basic/sysinfo.h"
+#include "basic/logs.h"
+
+#include <list>
+#include <sstream>
 
 namespace peco {
 
@@ -37,7 +42,11 @@ namespace peco {
  * @brief Default C'str
 */
 loopimpl::loopimpl() {
-
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    priority_time_[i] = duration_t::zero();
+    ready_head_[i] = nullptr;
+    ready_tail_[i] = nullptr;
+  }
 }
 /**
  * @brief Singleton loopimpl
@@ -60,56 +69,70 @@ void loopimpl::main() {
   // Invoke base init(which is platform-related)
   this->init(
     [=](long fd) {
-      auto id_list = this->timed_list_.search_all(fd);
-      // erase task related with this fd
-      this->timed_list_.erase(fd);
-      for (const auto& tid : id_list) {
-        auto ptrt = basic_task::fetch(tid);
-        if (ptrt) {
-          ptrt->get_task()->signal = kWaitingSignalBroken;
-          ptrt->get_task()->next_fire_time = TASK_TIME_NOW();
-          // Run this task in next loop
-          this->timed_list_.insert(ptrt, nullptr);
-        }
-      }
+      this->wakeup_waiters_(fd, kEventTypeRead, kWaitingSignalBroken);
+      this->wakeup_waiters_(fd, kEventTypeWrite, kWaitingSignalBroken);
+      this->wakeup_waiters_(fd, kEventTypeError, kWaitingSignalBroken);
     },
     [=](long fd, EventType event_type) {
-      auto id_list = this->timed_list_.search(fd, event_type);
-      for (const auto& tid: id_list) {
-        auto ptrt = basic_task::fetch(tid);
-        this->timed_list_.erase(ptrt, fd, event_type);
-        if (ptrt) {
-          ptrt->get_task()->signal = kWaitingSignalReceived;
-          ptrt->get_task()->next_fire_time = TASK_TIME_NOW();
-          // Run this task in next loop
-          this->timed_list_.insert(ptrt, nullptr);
-        }
-      }
+      this->wakeup_waiters_(fd, event_type, kWaitingSignalReceived);
+    },
+    [=](int signo) {
+      auto h_it = this->signal_handlers_.find(signo);
+      if (h_it == this->signal_handlers_.end()) return;
+      auto handler = h_it->second;
+      auto ptrt = basic_task::create_task([handler, signo]() {
+        handler(signo);
+      });
+      ptrt->set_name("signal");
+      this->add_task(ptrt);
     });
 
   running_ = true;
   begin_time_ = TASK_TIME_NOW();
-  while (basic_task::cache_size() > 0) {
-    while (this->timed_list_.size() > 0 && TASK_TIME_NOW() >= this->timed_list_.nearest_time()) {
-      auto result = this->timed_list_.fetch();
-      if (result.on_time) {
-        result.on_time();
-      }
-      auto ptrt = basic_task::fetch(result.tid);
+  while (basic_task::cache_size() > 0 || this->timer_list_.size() > 0) {
+    // fire all timedout stackless timers on main context
+    this->timer_list_.fire(TASK_TIME_NOW());
+    while (true) {
+      auto now = TASK_TIME_NOW();
+      this->collect_ready_tasks_(now);
+      auto ptrt = this->pick_ready_task_(now);
+      if (ptrt == nullptr) break;
+      auto priority = ptrt->priority();
+      ptrt->get_task()->last_run_time = now;
       // Switch to the task
       ptrt->swap_to_task();
+      priority_time_[priority] += (TASK_TIME_NOW() - now);
       if (ptrt->status() == kTaskStatusStopped) {
         ptrt->destroy_task();
+        // Tell the draining task that one more task has gone
+        if (drain_tid_ != kInvalidateTaskId) {
+          this->wakeup_task(basic_task::fetch(drain_tid_), kWaitingSignalReceived);
+        }
       } else if (ptrt->status() == kTaskStatusPending) {
-        this->timed_list_.insert(ptrt, nullptr);
+        this->timed_list_.insert(ptrt->get_task());
       }
     }
+    // All ready tasks are done, run the idle hooks, they may create new
+    // ready tasks, so go back to check before waiting
+    if (this->idle_hooks_.size() > 0) {
+      this->running_hooks_.swap(this->idle_hooks_);
+      for (auto& hook : this->running_hooks_) {
+        hook();
+      }
+      this->running_hooks_.clear();
+      continue;
+    }
     // after all timed task's executing, if there is no
-    // cached task, stop the loop
-    if (basic_task::cache_size() == 0) break;
+    // cached task and timer, stop the loop
+    if (basic_task::cache_size() == 0 && this->timer_list_.size() == 0) break;
+
+    // Another thread asks the loop to exit
+    if (this->interrupted()) running_ = false;
 
     // Someone stop the loop, should cancel all task
     if (!running_) {
+      // Timers will never be fired after exiting
+      this->timer_list_.clear();
       // Mark all task to be cancelled
       basic_task::foreach([=](std::shared_ptr<basic_task> ptrt) {
         this->cancel(ptrt);
@@ -117,16 +140,168 @@ void loopimpl::main() {
       continue;
     }
 
-    auto idle_gap = (this->timed_list_.size() > 0 ? 
-      (this->timed_list_.nearest_time() - TASK_TIME_NOW()) : 
+    auto nearest_time = task_time_t::max();
+    if (this->timed_list_.size() > 0) {
+      nearest_time = this->timed_list_.nearest_time();
+    }
+    if (this->timer_list_.size() > 0) {
+      nearest_time = std::min(nearest_time, this->timer_list_.nearest_time());
+    }
+    auto idle_gap = (nearest_time != task_time_t::max() ?
+      (nearest_time - TASK_TIME_NOW()) :
       PECO_TIME_MS(1000));
     if (idle_gap.count() < 0) continue;
+    if (task_clock::mode() == kClockModeVirtual && nearest_time != task_time_t::max()) {
+      // Only poll the fds, if nothing happens, jump straight to the next
+      // timed task or timer, the jump is counted as idle time
+      if (this->wait(duration_t::zero()) == 0) {
+        time_waited_ += idle_gap.count();
+        task_clock::advance_to(nearest_time);
+      }
+      continue;
+    }
     // wait fd event until idle_gap
-    this->wait(idle_gap);
+    this->idle_wait_(idle_gap);
   }
   // force to stop if we break from last while loop
   this->stop();
+  running_ = false;
 }
+/**
+ * @brief Move all timedout tasks into the ready queues
+*/
+void loopimpl::collect_ready_tasks_(task_time_t now) {
+  while (this->timed_list_.size() > 0 && now >= this->timed_list_.nearest_time()) {
+    auto t = this->timed_list_.fetch();
+    if (t->wait_fd != -1l) {
+      // Timedout when waiting for fd event, stop monitoring if no one
+      // else is waiting for the same event
+      long fd = t->wait_fd;
+      EventType event_type = t->wait_event;
+      this->timed_list_.del_waiter(t);
+      if (!this->timed_list_.has_waiter(fd, event_type)) {
+        // The error event is released by its owner
+        if (event_type == kEventTypeRead) {
+          this->del_read_event(fd);
+        } else if (event_type == kEventTypeWrite) {
+          this->del_write_event(fd);
+        }
+      }
+      if (t->cancelled) {
+        t->signal = kWaitingSignalBroken;
+      }
+    }
+    this->push_ready_(t, now);
+  }
+}
+
+/**
+ * @brief Append the task to the ready queue of its priority class
+*/
+void loopimpl::push_ready_(task_context_t* t, task_time_t now) {
+  t->ready = true;
+  t->ready_time = now;
+  t->ready_next = nullptr;
+  if (this->ready_tail_[t->priority] != nullptr) {
+    this->ready_tail_[t->priority]->ready_next = t;
+  } else {
+    this->ready_head_[t->priority] = t;
+  }
+  this->ready_tail_[t->priority] = t;
+  ++ready_count_;
+}
+
+/**
+ * @brief Pick the next task to run from the ready queues, tasks with
+ * higher priority first, unless a lower one has been starving
+*/
+std::shared_ptr<basic_task> loopimpl::pick_ready_task_(task_time_t now) {
+  while (ready_count_ > 0) {
+    size_t picked = kTaskPriorityCount;
+    for (size_t p = 0; p < kTaskPriorityCount; ++p) {
+      if (this->ready_head_[p] == nullptr) continue;
+      if (picked == kTaskPriorityCount) {
+        picked = p;
+        continue;
+      }
+      // Starvation protection, promote the lower one if it has been
+      // waiting too long and is older than the current picked one
+      auto ready_time = this->ready_head_[p]->ready_time;
+      if ((now - ready_time) >= PECO_TIME_MS(PECO_TASK_STARVATION_LIMIT_MS) &&
+        ready_time < this->ready_head_[picked]->ready_time) {
+        picked = p;
+      }
+    }
+    auto t = this->ready_head_[picked];
+    this->ready_head_[picked] = t->ready_next;
+    if (this->ready_head_[picked] == nullptr) {
+      this->ready_tail_[picked] = nullptr;
+    }
+    t->ready_next = nullptr;
+    t->ready = false;
+    --ready_count_;
+    auto ptrt = basic_task::fetch(t->tid);
+    if (ptrt == nullptr) continue;
+    return ptrt;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Wake up all tasks waiting for the fd's event with given signal
+*/
+void loopimpl::wakeup_waiters_(long fd, EventType event_type, WaitingSignal signal) {
+  auto now = TASK_TIME_NOW();
+  while (auto t = this->timed_list_.pop_waiter(fd, event_type)) {
+    t->signal = signal;
+    // Run this task in next loop
+    this->timed_list_.replace_time(t, now);
+  }
+}
+
+/**
+ * @brief Wait for fd events until idle_gap, spin with zero timeout
+ * before blocking if busy-polling is enabled
+*/
+void loopimpl::idle_wait_(duration_t idle_gap) {
+  if (busy_poll_max_.count() == 0) {
+    this->wait(idle_gap);
+    return;
+  }
+  auto begin = TASK_TIME_NOW();
+  auto budget = std::min(busy_poll_budget_, idle_gap);
+  if (budget.count() > 0) {
+    // Spinning is not waiting, keep it out of the core's wait time
+    auto waited = time_waited_;
+    int count = 0;
+    do {
+      count = this->wait(duration_t::zero());
+    } while (count == 0 && (TASK_TIME_NOW() - begin) < budget);
+    time_waited_ = waited;
+    auto spin = TASK_TIME_NOW() - begin;
+    busy_poll_time_ += spin;
+    // Got event while spinning (or the core has been stopped), the
+    // budget is fine
+    if (count != 0) return;
+    idle_gap -= spin;
+    if (idle_gap.count() <= 0) return;
+  }
+  int count = this->wait(idle_gap);
+  auto idle = TASK_TIME_NOW() - begin;
+  if (idle > busy_poll_max_) {
+    // Events are coming slower than we can afford to spin
+    busy_poll_budget_ /= 2;
+    if (busy_poll_budget_ < PECO_TIME_US(PECO_BUSY_POLL_GROW_START_US)) {
+      busy_poll_budget_ = duration_t::zero();
+    }
+  } else if (count > 0) {
+    // The event came in within the max budget, spin longer next time
+    busy_poll_budget_ = (busy_poll_budget_.count() == 0 ?
+      PECO_TIME_US(PECO_BUSY_POLL_GROW_START_US) : busy_poll_budget_ * 2);
+    busy_poll_budget_ = std::min(busy_poll_budget_, busy_poll_max_);
+  }
+}
+
 /**
  * @brief Exit with given code
 */
@@ -135,11 +310,204 @@ void loopimpl::exit(int code) {
   running_ = false;
   this->stop();
 }
+/**
+ * @brief Cancel all listeners, wait other tasks to finish until the
+ * deadline, then cancel the rest and drop all timers. Must be invoked in a task.
+ * @return the count of tasks been force cancelled
+*/
+size_t loopimpl::drain(duration_t deadline) {
+  auto self = basic_task::running_task();
+  if (self == nullptr) {
+    log::error << "drain must be invoked in a task" << std::endl;
+    return 0;
+  }
+  if (drain_tid_ != kInvalidateTaskId) {
+    log::error << "the loop is already draining" << std::endl;
+    return 0;
+  }
+  auto end_time = TASK_TIME_NOW() + deadline;
+  // Stop accepting new work
+  std::list<std::shared_ptr<basic_task>> listeners;
+  basic_task::foreach([&](std::shared_ptr<basic_task> ptrt) {
+    if (ptrt != self && ptrt->is_listener()) listeners.push_back(ptrt);
+  });
+  for (auto& ptrt : listeners) {
+    this->cancel(ptrt);
+  }
+  // Wait until only current task remains, the destroyed tasks will
+  // wake us up
+  drain_tid_ = self->task_id();
+  while (basic_task::cache_size() > 1 && !self->cancelled()) {
+    auto now = TASK_TIME_NOW();
+    if (now >= end_time) break;
+    this->hold_task_for(self, end_time - now);
+  }
+  drain_tid_ = kInvalidateTaskId;
+  // Stackless timers are never done by themselves, drop them
+  this->timer_list_.clear();
+  // Force to cancel the rest
+  size_t forced = 0;
+  basic_task::foreach([&](std::shared_ptr<basic_task> ptrt) {
+    if (ptrt == self || ptrt->cancelled()) return;
+    this->cancel(ptrt);
+    ++forced;
+  });
+  return forced;
+}
+
+/**
+ * @brief Dump all tasks of the loop, one line per task
+*/
+std::string loopimpl::dump_tasks() const {
+  static const char* status_names[] = { "pending", "running", "paused", "stopped" };
+  auto now = TASK_TIME_NOW();
+  auto to_ms = [](duration_t d) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+  };
+  std::ostringstream oss;
+  oss << "tasks: " << basic_task::cache_size() << std::endl;
+  basic_task::foreach([&](std::shared_ptr<basic_task> ptrt) {
+    auto t = ptrt->get_task();
+    oss << "tid: 0x" << std::hex << t->tid << std::dec;
+    oss << ", name: " << ptrt->get_name();
+    oss << ", parent: ";
+    if (ptrt->parent_task() == kInvalidateTaskId) {
+      oss << "none";
+    } else {
+      oss << "0x" << std::hex << ptrt->parent_task() << std::dec;
+    }
+    oss << ", status: " << status_names[t->status];
+    if (t->cancelled) oss << "(cancelled)";
+    oss << ", wait: ";
+    if (t->status != kTaskStatusPaused) {
+      oss << "none";
+    } else if (t->last_run_time == task_time_t::min()) {
+      oss << "start";
+    } else if (t->ready) {
+      oss << "ready";
+    } else if (t->wait_fd != -1l) {
+      const char* event_name = (t->wait_event == kEventTypeRead ? "read" :
+        (t->wait_event == kEventTypeWrite ? "write" : "error"));
+      oss << "fd(" << t->wait_fd << ") " << event_name
+        << " " << to_ms(t->next_fire_time - now) << "ms";
+    } else if (t->heap_index != HEAP_INDEX_INVALID) {
+      oss << "timer " << to_ms(t->next_fire_time - now) << "ms";
+    } else {
+      oss << "hold";
+    }
+    oss << ", last run: ";
+    if (t->last_run_time == task_time_t::min()) {
+      oss << "never";
+    } else {
+      oss << to_ms(now - t->last_run_time) << "ms ago";
+    }
+    oss << ", stack at suspend: " << t->stack_at_suspend << std::endl;
+  });
+  return oss.str();
+}
+
+/**
+ * @brief Add a stackless timer which will be invoked on main context
+*/
+timer_id_t loopimpl::add_timer(worker_t worker, duration_t delay, duration_t interval, bool repeat) {
+  return this->timer_list_.add(std::move(worker), TASK_TIME_NOW() + delay, interval, repeat);
+}
+
+/**
+ * @brief Invoke the hook once on main context before the loop waits for events
+*/
+void loopimpl::add_idle_hook(worker_t hook) {
+  if (!hook) return;
+  this->idle_hooks_.emplace_back(std::move(hook));
+}
+
+/**
+ * @brief Cancel a stackless timer
+*/
+void loopimpl::cancel_timer(timer_id_t tid) {
+  this->timer_list_.cancel(tid);
+}
+
+/**
+ * @brief Check if the timer is still alive
+*/
+bool loopimpl::has_timer(timer_id_t tid) const {
+  return this->timer_list_.has(tid);
+}
+
+/**
+ * @brief Dispatch the signal to the handler as a normal task,
+ * remove the handler if it is null
+*/
+bool loopimpl::set_signal_handler(int signo, signal_handler_t handler) {
+  if (!handler) {
+    this->signal_handlers_.erase(signo);
+    this->del_signal(signo);
+    basic_task::set_signal_blocked(signo, false);
+    return true;
+  }
+  if (!this->add_signal(signo)) return false;
+  basic_task::set_signal_blocked(signo, true);
+  this->signal_handlers_[signo] = handler;
+  return true;
+}
+
 /**
  * @brief Get the load average of current loop
 */
 double loopimpl::load_average() const {
-  return 1.0 - ((double)this->get_wait_time() / (double)(TASK_TIME_NOW() - begin_time_).count());
+  // Time spent on busy-polling is counted as idle
+  auto idle = this->get_wait_time() + busy_poll_time_.count();
+  return 1.0 - ((double)idle / (double)(TASK_TIME_NOW() - begin_time_).count());
+}
+
+/**
+ * @brief Get the total running time of tasks in given priority class
+*/
+duration_t loopimpl::priority_time(TaskPriority priority) const {
+  if ((size_t)priority >= kTaskPriorityCount) return duration_t::zero();
+  return priority_time_[priority];
+}
+
+/**
+ * @brief Set the max spin budget before blocking on the core,
+ * zero to disable busy-polling
+*/
+void loopimpl::set_busy_poll(duration_t max_budget) {
+  if (max_budget.count() < 0) max_budget = duration_t::zero();
+  // Spinning on the only cpu just delays whoever is producing the events
+  if (max_budget.count() > 0 && cpu_count() < 2) {
+    log::warning << "busy-poll is disabled on single cpu host" << std::endl;
+    max_budget = duration_t::zero();
+  }
+  busy_poll_max_ = max_budget;
+  busy_poll_budget_ = std::min(busy_poll_budget_, busy_poll_max_);
+}
+
+/**
+ * @brief Get the current self-tuned spin budget
+*/
+duration_t loopimpl::busy_poll_budget() const {
+  return busy_poll_budget_;
+}
+
+/**
+ * @brief Get the total time spent on busy-polling
+*/
+duration_t loopimpl::busy_poll_time() const {
+  return busy_poll_time_;
+}
+
+/**
+ * @brief Switch the clock mode, only before the loop starts running
+*/
+bool loopimpl::set_clock_mode(ClockMode mode) {
+  if (running_) {
+    log::error << "cannot switch the clock mode of a running loop" << std::endl;
+    return false;
+  }
+  task_clock::set_mode(mode);
+  return true;
 }
 
 /**
@@ -157,7 +525,19 @@ void loopimpl::add_task(std::shared_ptr<basic_task> ptrt) {
   assert(ptrt->status() != kTaskStatusStopped);
 
   ptrt->get_task()->status = kTaskStatusPaused;
-  this->timed_list_.insert(ptrt, nullptr);
+  this->timed_list_.insert(ptrt->get_task());
+}
+
+/**
+ * @brief Put all new tasks into the ready queues at once
+*/
+void loopimpl::add_ready_tasks(const std::vector<std::shared_ptr<basic_task>>& tasks) {
+  auto now = TASK_TIME_NOW();
+  for (const auto& ptrt : tasks) {
+    assert(ptrt->status() != kTaskStatusStopped);
+    ptrt->get_task()->status = kTaskStatusPaused;
+    this->push_ready_(ptrt->get_task(), now);
+  }
 }
 
 /**
@@ -169,7 +549,7 @@ void loopimpl::yield_task(std::shared_ptr<basic_task> ptrt) {
   assert(ptrt->task_id() == basic_task::running_task()->task_id());
   ptrt->get_task()->next_fire_time = TASK_TIME_NOW();
   ptrt->get_task()->status = kTaskStatusPaused;
-  this->timed_list_.insert(ptrt, nullptr);
+  this->timed_list_.insert(ptrt->get_task());
   basic_task::swap_to_main();
 }
 
@@ -208,10 +588,31 @@ void loopimpl::hold_task_for(std::shared_ptr<basic_task> ptrt, duration_t timedo
     ptrt->get_task()->signal = kWaitingSignalBroken;
     return;
   }
+  // never wait beyond the task's deadline
+  timedout = ptrt->clamp_to_deadline(timedout);
   ptrt->get_task()->next_fire_time = (TASK_TIME_NOW() + timedout);
   ptrt->get_task()->status = kTaskStatusPaused;
-  this->timed_list_.insert(ptrt, nullptr);
+  this->timed_list_.insert(ptrt->get_task());
+  basic_task::swap_to_main();
+}
+
+/**
+ * @brief Park a persistent loop task until its next fire time,
+ * return false if the task has been cancelled
+*/
+bool loopimpl::park_until_next_fire(std::shared_ptr<basic_task> ptrt) {
+  if (ptrt == nullptr) return false;
+  // only running task can be parked
+  assert(ptrt->task_id() == basic_task::running_task()->task_id());
+  auto t = ptrt->get_task();
+  if (t->cancelled) return false;
+  // Same schedule as a reset loop task
+  t->next_fire_time += t->interval;
+  t->signal = kWaitingSignalNothing;
+  t->status = kTaskStatusPaused;
+  this->timed_list_.insert(t);
   basic_task::swap_to_main();
+  return !t->cancelled;
 }
 
 /**
@@ -225,64 +626,63 @@ void loopimpl::wakeup_task(std::shared_ptr<basic_task> ptrt, WaitingSignal signa
     (ptrt->task_id() != basic_task::running_task()->task_id())
   );
   ptrt->get_task()->signal = signal;
-  if (this->timed_list_.has(ptrt)) {
-    this->timed_list_.replace_time(ptrt, TASK_TIME_NOW());
-  } else {
-    this->timed_list_.insert(ptrt, nullptr);
-  }
+  // Already in the ready queue, will be switched to soon
+  if (ptrt->get_task()->ready) return;
+  ptrt->get_task()->next_fire_time = TASK_TIME_NOW();
+  this->timed_list_.insert(ptrt->get_task());
 }
 
 /**
- * @brief Monitor the fd for reading event and put the task into
- * timed list with a timedout handler
+ * @brief Monitor the fd's event until timedout
 */
-void loopimpl::wait_for_reading(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout) {
+void loopimpl::wait_for_event_(long fd, EventType event_type, std::shared_ptr<basic_task> ptrt, duration_t timedout) {
   if (ptrt == nullptr) return;
-
   // if the task has already been marked as canceled,
   // just return, not allowed to be holded.
   if (ptrt->get_task()->cancelled) {
     ptrt->get_task()->signal = kWaitingSignalBroken;
     return;
   }
-  ptrt->get_task()->signal = kWaitingSignalNothing;
-  ptrt->get_task()->status = kTaskStatusPaused;
-  ptrt->get_task()->next_fire_time = (TASK_TIME_NOW() + timedout);
-  this->timed_list_.insert(ptrt, [=]() {
-    this->timed_list_.erase(ptrt, fd);
-    this->del_read_event(fd);
-    if (ptrt->get_task()->cancelled) {
-      ptrt->get_task()->signal = kWaitingSignalBroken;
-    }
-  }, fd, kEventTypeRead);
-  this->add_read_event(fd);
+  auto t = ptrt->get_task();
+  t->signal = kWaitingSignalNothing;
+  t->status = kTaskStatusPaused;
+  // never wait beyond the task's deadline
+  timedout = ptrt->clamp_to_deadline(timedout);
+  t->next_fire_time = (TASK_TIME_NOW() + timedout);
+  this->timed_list_.insert(t);
+  this->timed_list_.add_waiter(t, fd, event_type);
+  if (event_type == kEventTypeRead) {
+    this->add_read_event(fd);
+  } else if (event_type == kEventTypeWrite) {
+    this->add_write_event(fd);
+  } else {
+    this->add_error_event(fd);
+  }
   basic_task::swap_to_main();
 }
 
+/**
+ * @brief Monitor the fd for reading event and put the task into
+ * timed list with a timedout handler
+*/
+void loopimpl::wait_for_reading(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout) {
+  this->wait_for_event_(fd, kEventTypeRead, ptrt, timedout);
+}
+
 /**
  * @brief Monitor the fd for writing buffer and put the task into
  * timed list with a timedout handler
 */
 void loopimpl::wait_for_writing(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout) {
-  if (ptrt == nullptr) return;
-  // if the task has already been marked as canceled,
-  // just return, not allowed to be holded.
-  if (ptrt->get_task()->cancelled) {
-    ptrt->get_task()->signal = kWaitingSignalBroken;
-    return;
-  }
-  ptrt->get_task()->signal = kWaitingSignalNothing;
-  ptrt->get_task()->status = kTaskStatusPaused;
-  ptrt->get_task()->next_fire_time = (TASK_TIME_NOW() + timedout);
-  this->timed_list_.insert(ptrt, [=]() {
-    this->timed_list_.erase(ptrt, fd);
-    this->del_write_event(fd);
-    if (ptrt->get_task()->cancelled) {
-      ptrt->get_task()->signal = kWaitingSignalBroken;
-    }
-  }, fd, kEventTypeWrite);
-  this->add_write_event(fd);
-  basic_task::swap_to_main();
+  this->wait_for_event_(fd, kEventTypeWrite, ptrt, timedout);
+}
+
+/**
+ * @brief Monitor the fd's error queue and put the task into timed
+ * list with a timedout handler
+*/
+void loopimpl::wait_for_errors(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout) {
+  this->wait_for_event_(fd, kEventTypeError, ptrt, timedout);
 }
 
 /**
@@ -294,20 +694,27 @@ void loopimpl::cancel(std::shared_ptr<basic_task> ptrt) {
   // The task is already been marked as cancelled, do nothing
   if (ptrt->get_task()->cancelled) return;
   ptrt->get_task()->cancelled = true;
+  ptrt->publish_snapshot();
   // Cancel self
   if (basic_task::running_task() == ptrt) {
     // Means the task is not in the timed_list and not holding
     // we dont need to do anything
     return;
   }
+  // The task is waiting in the ready queue, all pending event
+  // has already been processed
+  if (ptrt->get_task()->ready) {
+    ptrt->get_task()->signal = kWaitingSignalBroken;
+    return;
+  }
 
   // The task is just been holded, force to wakeup
-  if (!this->timed_list_.has(ptrt)) {
+  if (!this->timed_list_.has(ptrt->get_task())) {
     this->wakeup_task(ptrt, kWaitingSignalBroken);
   } else {
     // Mark the task's next fire time to now, force all pending
     // event to be timedout
-    this->timed_list_.replace_time(ptrt, TASK_TIME_NOW());
+    this->timed_list_.replace_time(ptrt->get_task(), TASK_TIME_NOW());
   }
 }
 
@@ -38,8 +38,13 @@ SOFTWARE.
 #include "task/impl/taskcontext.hxx"
 #include "task/impl/stackcache.hxx"
 #include "task/impl/tasklist.hxx"
+#include "task/impl/timerlist.hxx"
+#include "task/impl/taskclock.hxx"
+
 #include "task/impl/loopcore.hxx"
 
+#include <map>
+
 namespace peco {
 
 class loopimpl : public loopcore {
@@ -79,6 +84,11 @@ public:
   */
   void add_task(std::shared_ptr<basic_task> ptrt);
 
+  /**
+   * @brief Put all new tasks into the ready queues at once
+  */
+  void add_ready_tasks(const std::vector<std::shared_ptr<basic_task>>& tasks);
+
   /**
    * @brief Yield a task
   */
@@ -95,6 +105,12 @@ public:
   */
   void hold_task_for(std::shared_ptr<basic_task> ptrt, duration_t timedout);
 
+  /**
+   * @brief Park a persistent loop task until its next fire time,
+   * return false if the task has been cancelled
+  */
+  bool park_until_next_fire(std::shared_ptr<basic_task> ptrt);
+
   /**
    * @brief brief
   */
@@ -112,21 +128,136 @@ public:
   */
   void wait_for_writing(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout);
 
+  /**
+   * @brief Monitor the fd's error queue and put the task into timed
+   * list with a timedout handler
+  */
+  void wait_for_errors(long fd, std::shared_ptr<basic_task> ptrt, duration_t timedout);
+
   /**
    * @brief Cancel a repeatable or delay task
    * If a task is running, will wakeup and set the status to cancel
   */
   void cancel(std::shared_ptr<basic_task> ptrt);
 
+  /**
+   * @brief Cancel all listeners, wait other tasks to finish until the
+   * deadline, then cancel the rest and drop all timers. Must be invoked in a task.
+   * @return the count of tasks been force cancelled
+  */
+  size_t drain(duration_t deadline);
+
+  /**
+   * @brief Dump all tasks of the loop, one line per task
+  */
+  std::string dump_tasks() const;
+
+  /**
+   * @brief Add a stackless timer which will be invoked on main context
+  */
+  timer_id_t add_timer(worker_t worker, duration_t delay, duration_t interval, bool repeat);
+
+  /**
+   * @brief Invoke the hook once on main context before the loop waits for events
+  */
+  void add_idle_hook(worker_t hook);
+
+  /**
+   * @brief Cancel a stackless timer
+  */
+  void cancel_timer(timer_id_t tid);
+
+  /**
+   * @brief Check if the timer is still alive
+  */
+  bool has_timer(timer_id_t tid) const;
+
+  /**
+   * @brief Dispatch the signal to the handler as a normal task,
+   * remove the handler if it is null
+  */
+  bool set_signal_handler(int signo, signal_handler_t handler);
+
   /**
    * @brief Get the load average of current loop
   */
   double load_average() const;
 
+  /**
+   * @brief Get the total running time of tasks in given priority class
+  */
+  duration_t priority_time(TaskPriority priority) const;
+
+  /**
+   * @brief Set the max spin budget before blocking on the core,
+   * zero to disable busy-polling
+  */
+  void set_busy_poll(duration_t max_budget);
+
+  /**
+   * @brief Get the current self-tuned spin budget
+  */
+  duration_t busy_poll_budget() const;
+
+  /**
+   * @brief Get the total time spent on busy-polling
+  */
+  duration_t busy_poll_time() const;
+
+  /**
+   * @brief Switch the clock mode, only before the loop starts running
+  */
+  bool set_clock_mode(ClockMode mode);
+
+protected:
+  /**
+   * @brief Move all timedout tasks into the ready queues
+  */
+  void collect_ready_tasks_(task_time_t now);
+
+  /**
+   * @brief Append the task to the ready queue of its priority class
+  */
+  void push_ready_(task_context_t* t, task_time_t now);
+
+  /**
+   * @brief Pick the next task to run from the ready queues, tasks with
+   * higher priority first, unless a lower one has been starving
+  */
+  std::shared_ptr<basic_task> pick_ready_task_(task_time_t now);
+
+  /**
+   * @brief Wait for fd events until idle_gap, spin with zero timeout
+   * before blocking if busy-polling is enabled
+  */
+  void idle_wait_(duration_t idle_gap);
+
+  /**
+   * @brief Wake up all tasks waiting for the fd's event with given signal
+  */
+  void wakeup_waiters_(long fd, EventType event_type, WaitingSignal signal);
+
+  /**
+   * @brief Monitor the fd's event until timedout
+  */
+  void wait_for_event_(long fd, EventType event_type, std::shared_ptr<basic_task> ptrt, duration_t timedout);
+
 protected:
   tasklist timed_list_;
+  timerlist timer_list_;
+  std::map<int, signal_handler_t> signal_handlers_;
+  task_context_t* ready_head_[kTaskPriorityCount];
+  task_context_t* ready_tail_[kTaskPriorityCount];
+  size_t ready_count_ = 0;
+  duration_t priority_time_[kTaskPriorityCount];
+  std::vector<worker_t> idle_hooks_;
+  std::vector<worker_t> running_hooks_;
+  duration_t busy_poll_max_ = duration_t::zero();
+  duration_t busy_poll_budget_ = duration_t::zero();
+  duration_t busy_poll_time_ = duration_t::zero();
   bool running_ = false;
   int exit_code_ = 0;
+  task_id_t drain_tid_ = kInvalidateTaskId;
   task_time_t begin_time_;
 };
 
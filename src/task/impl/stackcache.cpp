@@ -31,7 +31,7 @@ SOFTWARE.
 
 #include "task/impl/stackcache.hxx"
 
-#include <list>
+#include <vector>
 
 namespace peco {
 
@@ -39,13 +39,25 @@ class __stack_cache {
 public:
   stack_cache::task_buffer_ptr fetch() {
     if (cache_list_.size() > 0) {
-      auto buf = cache_list_.front();
-      cache_list_.pop_front();
+      // The last released one is most likely still in cpu cache
+      auto buf = std::move(cache_list_.back());
+      cache_list_.pop_back();
       return buf;
     } else {
       return std::make_shared<stack_cache::task_buffer_t>();
     }
   }
+  void fetch(size_t count, std::vector<stack_cache::task_buffer_ptr>& buffers) {
+    buffers.reserve(buffers.size() + count);
+    size_t cached = std::min(count, cache_list_.size());
+    buffers.insert(buffers.end(),
+      std::make_move_iterator(cache_list_.end() - cached),
+      std::make_move_iterator(cache_list_.end()));
+    cache_list_.resize(cache_list_.size() - cached);
+    for (size_t i = cached; i < count; ++i) {
+      buffers.emplace_back(std::make_shared<stack_cache::task_buffer_t>());
+    }
+  }
   void release(stack_cache::task_buffer_ptr buffer) {
     if (cache_list_.size() >= max_count_) {
       return;
@@ -65,8 +77,8 @@ public:
     return s_cache;
   }
 protected:
-  size_t max_count_;
-  std::list< stack_cache::task_buffer_ptr > cache_list_;
+  size_t max_count_ = (size_t)-1;
+  std::vector< stack_cache::task_buffer_ptr > cache_list_;
 }; 
 
 /**
@@ -76,6 +88,13 @@ stack_cache::task_buffer_ptr stack_cache::fetch() {
   return __stack_cache::instance().fetch();
 }
 
+/**
+ * @brief Fetch <count> stack buffers at once and append to <buffers>
+*/
+void stack_cache::fetch(size_t count, std::vector<task_buffer_ptr>& buffers) {
+  __stack_cache::instance().fetch(count, buffers);
+}
+
 /**
  * @brief Release the stack buffer
 */
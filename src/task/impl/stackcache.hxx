@@ -38,6 +38,8 @@ SOFTWARE.
 #include "basic/bufguard.h"
 #include "task/impl/taskcontext.hxx"
 
+#include <vector>
+
 namespace peco {
 
 class stack_cache {
@@ -52,6 +54,11 @@ public:
   */
   static task_buffer_ptr fetch();
 
+  /**
+   * @brief Fetch <count> stack buffers at once and append to <buffers>
+  */
+  static void fetch(size_t count, std::vector<task_buffer_ptr>& buffers);
+
   /**
    * @brief Release the stack buffer
   */
@@ -0,0 +1,84 @@
+/*
+    taskclock.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/impl/taskclock.hxx"
+
+namespace peco {
+
+static thread_local ClockMode g_clock_mode = kClockModeReal;
+static thread_local task_time_t g_virtual_now;
+
+/**
+ * @brief Current time of the loop clock in this thread
+*/
+task_time_t task_time_now() {
+  return task_clock::now();
+}
+
+/**
+ * @brief Get current time
+*/
+task_time_t task_clock::now() {
+  if (g_clock_mode == kClockModeVirtual) return g_virtual_now;
+  return steady_clock_t::now();
+}
+
+/**
+ * @brief Switch the clock mode, virtual time starts at the current
+ * steady time, so all scheduled time points are kept
+*/
+void task_clock::set_mode(ClockMode mode) {
+  if (mode == g_clock_mode) return;
+  if (mode == kClockModeVirtual) {
+    g_virtual_now = steady_clock_t::now();
+  }
+  g_clock_mode = mode;
+}
+
+/**
+ * @brief Get the clock mode
+*/
+ClockMode task_clock::mode() {
+  return g_clock_mode;
+}
+
+/**
+ * @brief Move the virtual time forward to <time_point>,
+ * does nothing in real mode or if the time point has passed
+*/
+void task_clock::advance_to(task_time_t time_point) {
+  if (g_clock_mode != kClockModeVirtual) return;
+  if (time_point > g_virtual_now) g_virtual_now = time_point;
+}
+
+} // namespace peco
+
+// Push Chen
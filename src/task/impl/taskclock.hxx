@@ -0,0 +1,76 @@
+/*
+    taskclock.hxx
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TASKCLOCK_HXX
+#define PECO_TASKCLOCK_HXX
+
+#include "pecostd.h"
+#include "task/taskdef.h"
+
+namespace peco {
+
+/**
+ * @brief The clock of the loop in current thread. In virtual mode the
+ * time is only moved by the loop, so timed logic runs without waiting
+ * and is reproducible.
+*/
+class task_clock {
+public:
+  /**
+   * @brief Get current time
+  */
+  static task_time_t now();
+
+  /**
+   * @brief Switch the clock mode, virtual time starts at the current
+   * steady time, so all scheduled time points are kept
+  */
+  static void set_mode(ClockMode mode);
+
+  /**
+   * @brief Get the clock mode
+  */
+  static ClockMode mode();
+
+  /**
+   * @brief Move the virtual time forward to <time_point>,
+   * does nothing in real mode or if the time point has passed
+  */
+  static void advance_to(task_time_t time_point);
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
@@ -75,6 +75,11 @@ typedef jmp_buf       stack_context_t;
 typedef ucontext_t    stack_context_t;
 #endif
 
+/**
+ * @brief Not in the timed heap
+*/
+#define HEAP_INDEX_INVALID        ((size_t)-1)
+
 /**
  * @brief Basic Task
 */
@@ -129,6 +134,68 @@ typedef struct __task_context__ {
   */
   duration_t                  interval;
 
+  /**
+   * @brief Priority class of the task
+  */
+  TaskPriority                priority;
+
+  /**
+   * @brief If the task is accepting new work, listeners are cancelled
+   * first when the loop is draining
+  */
+  bool                        listener;
+
+  /**
+   * @brief All waits of the task are clamped to this time point, inherited
+   * from the parent task, task_time_t::max() if there is no deadline
+  */
+  task_time_t                 deadline;
+
+  /**
+   * @brief If the task is in the loop's ready queue
+  */
+  bool                        ready;
+
+  /**
+   * @brief Time when the task was put into the ready queue
+  */
+  task_time_t                 ready_time;
+
+  /**
+   * @brief Next task in the same ready queue
+  */
+  struct __task_context__ *   ready_next;
+
+  /**
+   * @brief Position in the loop's timed heap, HEAP_INDEX_INVALID if not in
+  */
+  size_t                      heap_index;
+
+  /**
+   * @brief The fd and event the task is waiting for, -1 if not waiting
+  */
+  long                        wait_fd;
+  EventType                   wait_event;
+
+  /**
+   * @brief Siblings waiting for the same fd and event
+  */
+  struct __task_context__ *   wait_prev;
+  struct __task_context__ *   wait_next;
+
+  /**
+   * @brief Last time the task was switched in, task_time_t::min() if
+   * the task has never been run
+  */
+  task_time_t                 last_run_time;
+
+  /**
+   * @brief Deepest stack usage observed when the task yields, frames
+   * returned before a suspension point are not seen, so it is not the
+   * high-water mark of the stack
+  */
+  size_t                      stack_at_suspend;
+
   /**
    * @brief The stack context
   */
@@ -141,6 +208,13 @@ typedef struct __task_context__ {
   uint64_t                    zero[32];
 } task_context_t;
 
+/**
+ * @brief Max task local storage key count
+*/
+enum {
+  kMaxTaskLocalCount = 64
+};
+
 /**
  * @brief Extra info of a task
 */
@@ -165,11 +239,23 @@ typedef struct __task_extra__ {
    * @brief Parent task's id
   */
   task_id_t                   parent_tid;
+  /**
+   * @brief Bitmask of the constructed task local slots
+  */
+  uint64_t                    local_mask[kMaxTaskLocalCount / 64];
 } task_extra_t;
 
 enum {
-  kTaskContextSize = (sizeof(task_context_t) / sizeof(intptr_t) + 1) * sizeof(intptr_t)
+  kTaskContextSize = (sizeof(task_context_t) / sizeof(intptr_t) + 1) * sizeof(intptr_t),
+  kTaskExtraSize = (sizeof(task_extra_t) / sizeof(intptr_t) + 1) * sizeof(intptr_t),
+  /**
+   * @brief Task local storage is placed after the extra info, 16 bytes aligned,
+   * and uses all the remaining reserved space
+  */
+  kTaskLocalOffset = ((kTaskContextSize + kTaskExtraSize + 15) / 16) * 16,
+  kTaskLocalSize = STACK_RESERVED_SIZE - kTaskLocalOffset
 };
+static_assert(kTaskLocalOffset < STACK_RESERVED_SIZE, "STACK_RESERVED_SIZE is too small");
 
 }
 
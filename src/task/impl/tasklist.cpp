@@ -34,172 +34,186 @@ SOFTWARE.
 namespace peco {
 
 /**
- * @brief Inner Cache Key Item
+ * @brief Heap order, tasks may share the same fire time, use task
+ * id to break the tie
 */
-/**
- * @brief Create from the basic task ptr
-*/
-tasklist::cache_item_t::cache_item_t(basic_task_ptr_t t)
-  :tid(t->task_id()), next_fire_time(t->get_task()->next_fire_time) { }
-/**
- * @brief Operator to make this type can be map's key type
-*/
-bool tasklist::cache_item_t::operator <(const tasklist::cache_item_t& r) const {
-  return (this->tid != r.tid) && (this->next_fire_time < r.next_fire_time);
-}
-/**
- * @brief Simple operator == to fast map index
-*/
-bool tasklist::cache_item_t::operator == (const tasklist::cache_item_t& r) const {
-  return this->tid == r.tid;
-}
-bool tasklist::cache_item_t::operator != (const tasklist::cache_item_t& r) const {
-  return this->tid != r.tid;
-}
-/**
- * @brief Easy Cstor
- */
-tasklist::cache_fd_t::cache_fd_t(long fd, EventType etype) 
-  : fd(fd), event_type(etype) { }
-
-/**
- * @brief Operator to make this type can be map's key type
- */
-bool tasklist::cache_fd_t::operator<(const tasklist::cache_fd_t &r) const {
-  return this->fd < r.fd;
+bool tasklist::before_(const task_context_t* l, const task_context_t* r) {
+  if (l->next_fire_time != r->next_fire_time) {
+    return l->next_fire_time < r->next_fire_time;
+  }
+  return l->tid < r->tid;
 }
 
 /**
- * @brief Simple operator compare to fast map index
- */
-bool tasklist::cache_fd_t::operator==(const tasklist::cache_fd_t &r) const {
-  return (this->fd == r.fd && this->event_type == r.event_type);
-}
-bool tasklist::cache_fd_t::operator!=(const tasklist::cache_fd_t &r) const {
-  return (this->fd != r.fd || this->event_type != r.event_type);
+ * @brief Restore the heap order of the given position
+*/
+void tasklist::sift_up_(size_t index) {
+  auto t = heap_[index];
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!before_(t, heap_[parent])) break;
+    heap_[index] = heap_[parent];
+    heap_[index]->heap_index = index;
+    index = parent;
+  }
+  heap_[index] = t;
+  t->heap_index = index;
+}
+void tasklist::sift_down_(size_t index) {
+  auto t = heap_[index];
+  size_t count = heap_.size();
+  while (true) {
+    size_t child = index * 2 + 1;
+    if (child >= count) break;
+    if (child + 1 < count && before_(heap_[child + 1], heap_[child])) {
+      ++child;
+    }
+    if (!before_(heap_[child], t)) break;
+    heap_[index] = heap_[child];
+    heap_[index]->heap_index = index;
+    index = child;
+  }
+  heap_[index] = t;
+  t->heap_index = index;
 }
 
 /**
  * @brief Get the nearest fire time among all task in this list
 */
 task_time_t tasklist::nearest_time() const {
-  return ordered_time_map_.begin()->first.next_fire_time;
+  return heap_.front()->next_fire_time;
 }
 
 /**
  * @brief Fetch the task with the nearest fire time
 */
-tasklist::result_type tasklist::fetch() {
-  auto begin_it = ordered_time_map_.begin();
-  tasklist::result_type result{
-    begin_it->first.tid, begin_it->second
-  };
-  ordered_time_map_.erase(begin_it);
-  return result;
+task_context_t* tasklist::fetch() {
+  auto t = heap_.front();
+  this->erase(t);
+  return t;
 }
 
 /**
  * @brief Sort & Insert a task into the list
 */
-void tasklist::insert(tasklist::basic_task_ptr_t t, worker_t timedout_handler,
-                      long fd, EventType event_type) {
+void tasklist::insert(task_context_t* t) {
   if (t == nullptr) return;
-  ordered_time_map_[tasklist::cache_item_t(t)] = timedout_handler;
-  if (fd != -1l) {
-    // Rewrite the fd map
-    fd_cache_map_.emplace(cache_fd_t(fd, event_type), t->task_id());
+  if (t->heap_index != HEAP_INDEX_INVALID) {
+    this->replace_time(t, t->next_fire_time);
+    return;
   }
+  heap_.push_back(t);
+  this->sift_up_(heap_.size() - 1);
 }
 
 /**
  * @brief Replace a given task's next_fire_time to the fire_time
 */
-void tasklist::replace_time(tasklist::basic_task_ptr_t t, task_time_t fire_time) {
-  auto task_it = ordered_time_map_.find(cache_item_t(t));
+void tasklist::replace_time(task_context_t* t, task_time_t fire_time) {
   // No such task
-  if (task_it == ordered_time_map_.end()) return;
-  // Copy the on_time handler
-  auto on_time = std::move(task_it->second);
-  // Remove the old task
-  ordered_time_map_.erase(task_it);
-  t->get_task()->next_fire_time = fire_time;
-  ordered_time_map_[tasklist::cache_item_t(t)] = on_time;
+  if (t == nullptr || t->heap_index == HEAP_INDEX_INVALID) return;
+  t->next_fire_time = fire_time;
+  this->sift_up_(t->heap_index);
+  this->sift_down_(t->heap_index);
 }
 
 /**
  * @brief Remove a task from the list
 */
-void tasklist::erase(basic_task_ptr_t t, long fd, EventType event_type) {
-  if (t == nullptr) return;
-  tasklist::cache_item_t cache_key(t);
-  ordered_time_map_.erase(cache_key);
-  if (fd != -1l) {
-    auto fd_range = fd_cache_map_.equal_range(cache_fd_t(fd, event_type));
-    for (auto fd_it = fd_range.first; fd_it != fd_range.second;) {
-      if (fd_it->first.event_type == event_type && fd_it->second == t->task_id()) {
-        fd_it = fd_cache_map_.erase(fd_it);
-      } else {
-        ++fd_it;
-      }
-    }
-  }
-}
-
-/**
- * @brief Erase all fd related item
-*/
-void tasklist::erase(long fd) {
-  const static EventType kEventTypePool[] = {kEventTypeRead, kEventTypeWrite};
-  if (fd == -1l) return;
-  for (size_t i = 0; i < 2u; ++i) {
-    auto fd_range = fd_cache_map_.equal_range(cache_fd_t(fd, kEventTypePool[i]));
-    for (auto fd_it = fd_range.first; fd_it != fd_range.second;) {
-      // remove related timed list
-      auto ptrt = basic_task::fetch(fd_it->second);
-      if ( ptrt != nullptr ) {
-        ordered_time_map_.erase(cache_item_t(ptrt));
-      }
-      fd_it = fd_cache_map_.erase(fd_it);
-    }
-  }
+void tasklist::erase(task_context_t* t) {
+  if (t == nullptr || t->heap_index == HEAP_INDEX_INVALID) return;
+  size_t index = t->heap_index;
+  t->heap_index = HEAP_INDEX_INVALID;
+  auto last = heap_.back();
+  heap_.pop_back();
+  if (last == t) return;
+  heap_[index] = last;
+  last->heap_index = index;
+  this->sift_up_(index);
+  this->sift_down_(last->heap_index);
 }
 
 /**
  * @brief Get the task count
 */
 size_t tasklist::size() const {
-  return ordered_time_map_.size();
+  return heap_.size();
 }
 
 /**
  * @brief Check if the given task is in the list
 */
-bool tasklist::has(basic_task_ptr_t t) const {
-  return (ordered_time_map_.find(cache_item_t(t)) != ordered_time_map_.end());
+bool tasklist::has(const task_context_t* t) const {
+  return (t != nullptr && t->heap_index != HEAP_INDEX_INVALID);
 }
 
 /**
- * @brief Search task with the related fd
-*/
-std::list<task_id_t> tasklist::search(long fd, EventType event_type) {
-  std::list<task_id_t> result;
-  auto fd_range = fd_cache_map_.equal_range(cache_fd_t(fd, event_type));
-  for (auto fd_it = fd_range.first; fd_it != fd_range.second; ++fd_it) {
-    if (fd_it->first.event_type == event_type) {
-      result.push_back(fd_it->second);
-    }
+ * @brief Get the waiting list head of the fd's event
+*/
+task_context_t** tasklist::waiter_head_(long fd, EventType event_type) {
+  if (fd < 0) return nullptr;
+  if ((size_t)fd >= fd_waiters_.size()) {
+    fd_waiters_.resize((size_t)fd + 1, fd_waiters_t{nullptr, nullptr, nullptr});
   }
-  return result;
+  auto& w = fd_waiters_[fd];
+  if (event_type == kEventTypeRead) return &w.read_head;
+  if (event_type == kEventTypeWrite) return &w.write_head;
+  return &w.error_head;
+}
+
+/**
+ * @brief Mark the task as waiting for the fd's event
+*/
+void tasklist::add_waiter(task_context_t* t, long fd, EventType event_type) {
+  auto head = this->waiter_head_(fd, event_type);
+  if (t == nullptr || head == nullptr) return;
+  this->del_waiter(t);
+  t->wait_fd = fd;
+  t->wait_event = event_type;
+  t->wait_prev = nullptr;
+  t->wait_next = *head;
+  if (*head != nullptr) (*head)->wait_prev = t;
+  *head = t;
+}
+
+/**
+ * @brief Remove the task from its fd's waiting list
+*/
+void tasklist::del_waiter(task_context_t* t) {
+  if (t == nullptr || t->wait_fd == -1l) return;
+  auto head = this->waiter_head_(t->wait_fd, t->wait_event);
+  if (t->wait_prev != nullptr) {
+    t->wait_prev->wait_next = t->wait_next;
+  } else {
+    *head = t->wait_next;
+  }
+  if (t->wait_next != nullptr) {
+    t->wait_next->wait_prev = t->wait_prev;
+  }
+  t->wait_fd = -1l;
+  t->wait_prev = nullptr;
+  t->wait_next = nullptr;
+}
+
+/**
+ * @brief Remove and return the first task waiting for the fd's event
+*/
+task_context_t* tasklist::pop_waiter(long fd, EventType event_type) {
+  if (!this->has_waiter(fd, event_type)) return nullptr;
+  auto t = *this->waiter_head_(fd, event_type);
+  this->del_waiter(t);
+  return t;
 }
 
 /**
- * @brief Search all event's task
+ * @brief Check if any task is waiting for the fd's event
 */
-std::list<task_id_t> tasklist::search_all(long fd) {
-  auto read_result = this->search(fd, kEventTypeRead);
-  auto write_result = this->search(fd, kEventTypeWrite);
-  read_result.splice(read_result.end(), write_result);
-  return read_result;
+bool tasklist::has_waiter(long fd, EventType event_type) const {
+  if (fd < 0 || (size_t)fd >= fd_waiters_.size()) return false;
+  auto& w = fd_waiters_[fd];
+  if (event_type == kEventTypeRead) return w.read_head != nullptr;
+  if (event_type == kEventTypeWrite) return w.write_head != nullptr;
+  return w.error_head != nullptr;
 }
 
 } // namespace peco
@@ -28,152 +28,106 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
-
 #pragma once
 
 #ifndef PECO_TASKLIST_HXX
 #define PECO_TASKLIST_HXX
 
 #include "task/impl/taskcontext.hxx"
-#include "task/impl/basictask.hxx"
 
-#include <list>
-#include <map>
+#include <vector>
 
 namespace peco {
 
 /**
- * @brief Ordered task list by its until_time
+ * @brief Ordered task list by its next_fire_time, and the tasks waiting
+ * for fd events. All links are kept in the task context, so no memory
+ * will be allocated once the containers have grown to the working size.
 */
 class tasklist {
 public:
-  typedef std::shared_ptr<basic_task>   basic_task_ptr_t;
+  /**
+   * @brief Get the nearest fire time among all task in this list
+  */
+  task_time_t nearest_time() const;
 
   /**
-   * @brief Inner Cache Key Item
+   * @brief Fetch the task with the nearest fire time
   */
-  struct cache_item_t {
-    /**
-     * @brief Create from the basic task ptr
-    */
-    cache_item_t(basic_task_ptr_t t);
-    /**
-     * @brief Task ID
-    */
-    task_id_t     tid;
-    /**
-     * @brief Next fire time
-    */
-    task_time_t   next_fire_time;
-
-    /**
-     * @brief Operator to make this type can be map's key type
-    */
-    bool operator <(const cache_item_t& r) const;
-
-    /**
-     * @brief Simple operator compare to fast map index
-    */
-    bool operator == (const cache_item_t& r) const;
-    bool operator != (const cache_item_t& r) const;
-  };
+  task_context_t* fetch();
 
-  struct cache_fd_t {
-    /**
-     * @brief The cached fd
-    */
-    long          fd;
-    /**
-     * @brief One of the event type to monitor
-    */
-    EventType     event_type;
-
-    /**
-     * @brief Easy Cstor
-    */
-    cache_fd_t(long fd, EventType etype);
-
-    /**
-     * @brief Operator to make this type can be map's key type
-    */
-    bool operator <(const cache_fd_t& r) const;
-
-    /**
-     * @brief Simple operator compare to fast map index
-    */
-    bool operator == (const cache_fd_t& r) const;
-    bool operator != (const cache_fd_t& r) const;
-  };
+  /**
+   * @brief Sort & Insert a task into the list
+  */
+  void insert(task_context_t* t);
 
   /**
-   * @brief Item to return when fetch the nearest time
+   * @brief Replace a given task's next_fire_time to the fire_time
   */
-  struct result_type {
-    /**
-     * @brief Fetched task id
-    */
-    task_id_t     tid;
-    /**
-     * @brief Binded worker when timedout
-    */
-    worker_t      on_time;
-  };
+  void replace_time(task_context_t* t, task_time_t fire_time);
 
-public:
   /**
-   * @brief Get the nearest fire time among all task in this list
+   * @brief Remove a task from the list
   */
-  task_time_t nearest_time() const;
+  void erase(task_context_t* t);
 
   /**
-   * @brief Fetch the task with the nearest fire time
+   * @brief Get the task count
   */
-  result_type fetch();
+  size_t size() const;
 
   /**
-   * @brief Sort & Insert a task into the list
+   * @brief Check if the given task is in the list
   */
-  void insert(basic_task_ptr_t t, worker_t timedout_handler, 
-    long fd = -1l, EventType event_type = kEventTypeRead);
+  bool has(const task_context_t* t) const;
 
   /**
-   * @brief Replace a given task's next_fire_time to the fire_time
+   * @brief Mark the task as waiting for the fd's event
   */
-  void replace_time(basic_task_ptr_t t, task_time_t fire_time);
+  void add_waiter(task_context_t* t, long fd, EventType event_type);
 
   /**
-   * @brief Remove a task from the list
+   * @brief Remove the task from its fd's waiting list
   */
-  void erase(basic_task_ptr_t t, long fd = -1l, EventType event_type = kEventTypeRead);
+  void del_waiter(task_context_t* t);
 
   /**
-   * @brief Erase all fd related item
+   * @brief Remove and return the first task waiting for the fd's event
   */
-  void erase(long fd);
+  task_context_t* pop_waiter(long fd, EventType event_type);
 
   /**
-   * @brief Get the task count
+   * @brief Check if any task is waiting for the fd's event
   */
-  size_t size() const;
+  bool has_waiter(long fd, EventType event_type) const;
 
+protected:
   /**
-   * @brief Check if the given task is in the list
+   * @brief Heap order, tasks may share the same fire time, use task
+   * id to break the tie
   */
-  bool has(basic_task_ptr_t t) const;
+  static bool before_(const task_context_t* l, const task_context_t* r);
 
   /**
-   * @brief Search task with the related fd
+   * @brief Restore the heap order of the given position
   */
-  std::list<task_id_t> search(long fd, EventType event_type);
+  void sift_up_(size_t index);
+  void sift_down_(size_t index);
 
   /**
-   * @brief Search all event's task
+   * @brief Get the waiting list head of the fd's event
   */
-  std::list<task_id_t> search_all(long fd);
+  task_context_t** waiter_head_(long fd, EventType event_type);
 
 protected:
-  std::map<cache_item_t, worker_t>   ordered_time_map_;
-  std::multimap<cache_fd_t, task_id_t> fd_cache_map_;
+  struct fd_waiters_t {
+    task_context_t*   read_head;
+    task_context_t*   write_head;
+    task_context_t*   error_head;
+  };
+
+  std::vector<task_context_t*>  heap_;
+  std::vector<fd_waiters_t>     fd_waiters_;
 };
 
 } // namespace peco
@@ -0,0 +1,121 @@
+/*
+    tasksnapshot.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/impl/tasksnapshot.hxx"
+
+namespace peco {
+
+/**
+ * @brief Create an empty snapshot
+*/
+task_snapshot::task_snapshot()
+  : status_(kTaskStatusPending), signal_(kWaitingSignalNothing),
+    cancelled_(false), cancel_requested_(false), name_seq_(0) {
+  for (size_t i = 0; i <= kTaskNameLength; ++i) {
+    name_[i].store('\0', std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Publish the task's state, only invoke in the task's loop thread
+*/
+void task_snapshot::publish(TaskStatus status, WaitingSignal signal, bool cancelled) {
+  signal_.store(signal, std::memory_order_relaxed);
+  cancelled_.store(cancelled, std::memory_order_relaxed);
+  status_.store(status, std::memory_order_release);
+}
+
+/**
+ * @brief Publish the task's name, only invoke in the task's loop thread
+*/
+void task_snapshot::publish_name(const char* name) {
+  // Seqlock, odd sequence means the writer is in progress
+  name_seq_.fetch_add(1, std::memory_order_acq_rel);
+  size_t i = 0;
+  for (; name != nullptr && i < kTaskNameLength && name[i] != '\0'; ++i) {
+    name_[i].store(name[i], std::memory_order_relaxed);
+  }
+  name_[i].store('\0', std::memory_order_relaxed);
+  name_seq_.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Get the last published status
+*/
+TaskStatus task_snapshot::status() const {
+  return (TaskStatus)status_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Get the last published signal
+*/
+WaitingSignal task_snapshot::signal() const {
+  return (WaitingSignal)signal_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Tell if the task has been cancelled or requested to be cancelled
+*/
+bool task_snapshot::cancelled() const {
+  return cancelled_.load(std::memory_order_acquire) ||
+    cancel_requested_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Copy the last published name
+*/
+std::string task_snapshot::name() const {
+  std::string result;
+  uint32_t seq_begin = 0, seq_end = 0;
+  do {
+    result.clear();
+    seq_begin = name_seq_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < kTaskNameLength; ++i) {
+      char c = name_[i].load(std::memory_order_relaxed);
+      if (c == '\0') break;
+      result.push_back(c);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    seq_end = name_seq_.load(std::memory_order_relaxed);
+  } while ((seq_begin & 1u) || seq_begin != seq_end);
+  return result;
+}
+
+/**
+ * @brief Mark the cancel request, return false if already requested
+*/
+bool task_snapshot::request_cancel() {
+  return !cancel_requested_.exchange(true, std::memory_order_acq_rel);
+}
+
+} // namespace peco
+
+// Push Chen
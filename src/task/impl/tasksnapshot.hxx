@@ -0,0 +1,111 @@
+/*
+    tasksnapshot.hxx
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TASKSNAPSHOT_HXX
+#define PECO_TASKSNAPSHOT_HXX
+
+#include "pecostd.h"
+#include "task/taskdef.h"
+
+#include <atomic>
+
+namespace peco {
+
+/**
+ * @brief A lock-free snapshot of a task's state, published by the task's
+ * loop thread and can be read in any other thread.
+*/
+class task_snapshot {
+public:
+  /**
+   * @brief Create an empty snapshot
+  */
+  task_snapshot();
+
+  /**
+   * @brief No copy & move
+  */
+  task_snapshot(const task_snapshot&) = delete;
+  task_snapshot& operator = (const task_snapshot&) = delete;
+
+public:
+  /**
+   * @brief Publish the task's state, only invoke in the task's loop thread
+  */
+  void publish(TaskStatus status, WaitingSignal signal, bool cancelled);
+
+  /**
+   * @brief Publish the task's name, only invoke in the task's loop thread
+  */
+  void publish_name(const char* name);
+
+public:
+  /**
+   * @brief Get the last published status
+  */
+  TaskStatus status() const;
+
+  /**
+   * @brief Get the last published signal
+  */
+  WaitingSignal signal() const;
+
+  /**
+   * @brief Tell if the task has been cancelled or requested to be cancelled
+  */
+  bool cancelled() const;
+
+  /**
+   * @brief Copy the last published name
+  */
+  std::string name() const;
+
+  /**
+   * @brief Mark the cancel request, return false if already requested
+  */
+  bool request_cancel();
+
+protected:
+  std::atomic<int>        status_;
+  std::atomic<int>        signal_;
+  std::atomic<bool>       cancelled_;
+  std::atomic<bool>       cancel_requested_;
+  std::atomic<uint32_t>   name_seq_;
+  std::atomic<char>       name_[kTaskNameLength + 1];
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
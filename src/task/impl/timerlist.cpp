@@ -0,0 +1,134 @@
+/*
+    timerlist.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/impl/timerlist.hxx"
+
+namespace peco {
+
+/**
+ * @brief Add a new timer, return the timer id
+*/
+timer_id_t timerlist::add(worker_t worker, task_time_t fire_time, duration_t interval, bool repeat) {
+  auto tid = ++last_id_;
+  timer_map_.emplace(tid, timer_item_t{std::move(worker), fire_time, interval, repeat});
+  ordered_time_map_.emplace(fire_time, tid);
+  return tid;
+}
+
+/**
+ * @brief Cancel the timer, return false if no such timer
+*/
+bool timerlist::cancel(timer_id_t tid) {
+  auto timer_it = timer_map_.find(tid);
+  if (timer_it == timer_map_.end()) return false;
+  auto time_range = ordered_time_map_.equal_range(timer_it->second.next_fire_time);
+  for (auto time_it = time_range.first; time_it != time_range.second; ++time_it) {
+    if (time_it->second == tid) {
+      ordered_time_map_.erase(time_it);
+      break;
+    }
+  }
+  timer_map_.erase(timer_it);
+  return true;
+}
+
+/**
+ * @brief Check if the timer is still alive
+*/
+bool timerlist::has(timer_id_t tid) const {
+  return (timer_map_.find(tid) != timer_map_.end());
+}
+
+/**
+ * @brief Invoke all timers whose fire time is not later than <now>,
+ * return the fired timer count
+*/
+size_t timerlist::fire(task_time_t now) {
+  size_t fired_count = 0;
+  while (ordered_time_map_.size() > 0 && ordered_time_map_.begin()->first <= now) {
+    auto begin_it = ordered_time_map_.begin();
+    auto tid = begin_it->second;
+    ordered_time_map_.erase(begin_it);
+    auto timer_it = timer_map_.find(tid);
+    if (timer_it == timer_map_.end()) continue;
+
+    // Move the worker out, the timer may be cancelled inside the worker
+    worker_t worker = std::move(timer_it->second.worker);
+    bool repeat = timer_it->second.repeat;
+    if (repeat) {
+      auto& item = timer_it->second;
+      item.next_fire_time += item.interval;
+      // Do not burst to catch up, and never fire twice in one pass
+      if (item.next_fire_time <= now) {
+        item.next_fire_time = now + std::max(item.interval, PECO_TIME_NS(1));
+      }
+      ordered_time_map_.emplace(item.next_fire_time, tid);
+    } else {
+      timer_map_.erase(timer_it);
+    }
+    ++fired_count;
+    if (worker) worker();
+    if (repeat) {
+      // Put the worker back if the timer is still alive
+      timer_it = timer_map_.find(tid);
+      if (timer_it != timer_map_.end()) {
+        timer_it->second.worker = std::move(worker);
+      }
+    }
+  }
+  return fired_count;
+}
+
+/**
+ * @brief Get the nearest fire time among all timers in this list
+*/
+task_time_t timerlist::nearest_time() const {
+  return ordered_time_map_.begin()->first;
+}
+
+/**
+ * @brief Get the timer count
+*/
+size_t timerlist::size() const {
+  return timer_map_.size();
+}
+
+/**
+ * @brief Remove all timers
+*/
+void timerlist::clear() {
+  ordered_time_map_.clear();
+  timer_map_.clear();
+}
+
+} // namespace peco
+
+// Push Chen
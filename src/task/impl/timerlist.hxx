@@ -0,0 +1,105 @@
+/*
+    timerlist.hxx
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TIMERLIST_HXX
+#define PECO_TIMERLIST_HXX
+
+#include "pecostd.h"
+#include "task/taskdef.h"
+
+#include <map>
+#include <unordered_map>
+
+namespace peco {
+
+/**
+ * @brief Ordered stackless timer list by its fire time.
+ * All timers are invoked on the main context of the loop, no task
+ * or stack will be created for them.
+*/
+class timerlist {
+public:
+  /**
+   * @brief Add a new timer, return the timer id
+  */
+  timer_id_t add(worker_t worker, task_time_t fire_time, duration_t interval, bool repeat);
+
+  /**
+   * @brief Cancel the timer, return false if no such timer
+  */
+  bool cancel(timer_id_t tid);
+
+  /**
+   * @brief Check if the timer is still alive
+  */
+  bool has(timer_id_t tid) const;
+
+  /**
+   * @brief Invoke all timers whose fire time is not later than <now>,
+   * return the fired timer count
+  */
+  size_t fire(task_time_t now);
+
+  /**
+   * @brief Get the nearest fire time among all timers in this list
+  */
+  task_time_t nearest_time() const;
+
+  /**
+   * @brief Get the timer count
+  */
+  size_t size() const;
+
+  /**
+   * @brief Remove all timers
+  */
+  void clear();
+
+protected:
+  struct timer_item_t {
+    worker_t      worker;
+    task_time_t   next_fire_time;
+    duration_t    interval;
+    bool          repeat;
+  };
+
+  timer_id_t                                      last_id_ = 0;
+  std::multimap<task_time_t, timer_id_t>          ordered_time_map_;
+  std::unordered_map<timer_id_t, timer_item_t>    timer_map_;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
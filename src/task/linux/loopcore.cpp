@@ -30,10 +30,12 @@ SOFTWARE.
 */
 
 #include "task/impl/loopcore.hxx"
-#include <map>
+#include <vector>
 
 #include <sys/syscall.h>
 #include <sys/signal.h>
+#include <sys/signalfd.h>
+#include <pthread.h>
 #include <unistd.h>
 #define gettid()    syscall(__NR_gettid)
 
@@ -51,18 +53,22 @@ typedef struct epoll_event  core_event_t;
 
 namespace peco {
 
-typedef std::map<long, uint8_t> cached_fd_event_t;
+// Monitored events of each fd, indexed by the fd
+typedef std::vector<uint8_t> cached_fd_event_t;
 
 #define EPOLL_FD_NO_EVENT       (uint8_t)0
 #define EPOLL_FD_READ_EVENT     (uint8_t)0x01
-#define EPOLL_FD_NO_READ_EVENT  (uint8_t)0xFE
-#define EPOLL_FD_WRITE_EVENT    (uint8_t)2
-#define EPOLL_FD_NO_WRITE_EVENT (uint8_t)0xFD
+#define EPOLL_FD_WRITE_EVENT    (uint8_t)0x02
+// The fd has been added to the epoll set
+#define EPOLL_FD_REGISTERED     (uint8_t)0x04
+// EPOLLERR is always reported, the mark tells it comes from the error queue
+#define EPOLL_FD_ERROR_EVENT    (uint8_t)0x08
 
-#define __MARK_READ__(x)      (x) & EPOLL_FD_READ_EVENT
-#define __MARK_WRITE__(x)     (x) & EPOLL_FD_WRITE_EVENT
-#define __UNMARK_READ__(x)    (x) & EPOLL_FD_NO_READ_EVENT
-#define __UNMARK_WRITE__(x)   (x) & EPOLL_FD_NO_WRITE_EVENT
+#define __MARK_READ__(x)      (x) | EPOLL_FD_READ_EVENT
+#define __MARK_WRITE__(x)     (x) | EPOLL_FD_WRITE_EVENT
+#define __UNMARK_READ__(x)    (x) & ~EPOLL_FD_READ_EVENT
+#define __UNMARK_WRITE__(x)   (x) & ~EPOLL_FD_WRITE_EVENT
+#define __MONITORED_EVENTS__  (EPOLL_FD_READ_EVENT | EPOLL_FD_WRITE_EVENT | EPOLL_FD_ERROR_EVENT)
 
 inline int __core_event_ctl__(int core_fd, int so, uint32_t flag, int eid) {
   core_event_t e;
@@ -72,6 +78,9 @@ inline int __core_event_ctl__(int core_fd, int so, uint32_t flag, int eid) {
   if (-1 == epoll_ctl(core_fd, eid, so, &e)) {
     if (errno == EEXIST) {
       return epoll_ctl(core_fd, EPOLL_CTL_MOD, so, &e);
+    } else if (errno == ENOENT && eid == EPOLL_CTL_MOD) {
+      // The fd has been closed and removed from the epoll set
+      return epoll_ctl(core_fd, EPOLL_CTL_ADD, so, &e);
     } else {
       return -1;
     }
@@ -81,14 +90,53 @@ inline int __core_event_ctl__(int core_fd, int so, uint32_t flag, int eid) {
 }
 
 /**
- * @brief Init the core fd(if any) and bind the error and event handler
+ * @brief Get the cached event flag of the fd, grow the cache if needed
+*/
+inline uint8_t& __cached_event__(cached_fd_event_t* p_cache, long fd) {
+  if ((size_t)fd >= p_cache->size()) {
+    p_cache->resize((size_t)fd + 1, EPOLL_FD_NO_EVENT);
+  }
+  return (*p_cache)[fd];
+}
+
+/**
+ * @brief Apply the cached events of the fd to the epoll set
+*/
+inline int __core_event_apply__(int core_fd, long fd, uint8_t& flag) {
+  uint32_t events = EPOLLET;
+  if (flag & EPOLL_FD_READ_EVENT) events |= EPOLLIN;
+  if (flag & EPOLL_FD_WRITE_EVENT) events |= EPOLLOUT;
+  if ((flag & __MONITORED_EVENTS__) == EPOLL_FD_NO_EVENT) {
+    if (!(flag & EPOLL_FD_REGISTERED)) return 0;
+    flag = EPOLL_FD_NO_EVENT;
+    return __core_event_ctl__(core_fd, fd, events, EPOLL_CTL_DEL);
+  }
+  int eid = ((flag & EPOLL_FD_REGISTERED) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+  flag |= EPOLL_FD_REGISTERED;
+  return __core_event_ctl__(core_fd, fd, events, eid);
+}
+
+/**
+ * @brief Build the sigset from the signal bitmask
+*/
+inline void __core_signal_set__(uint64_t mask, sigset_t* set) {
+  sigemptyset(set);
+  for (int signo = 1; signo <= 64; ++signo) {
+    if (mask & (1ull << (signo - 1))) sigaddset(set, signo);
+  }
+}
+
+/**
+ * @brief Init the core fd(if any) and bind the error, event and signal handler
  */
 void loopcore::init(loopcore::core_error_handler_t herr,
-                    loopcore::core_event_handler_t hevent
+                    loopcore::core_event_handler_t hevent,
+                    loopcore::core_signal_handler_t hsignal
                     ) 
 {
   on_error_ = herr;
   on_event_ = hevent;
+  on_signal_ = hsignal;
 
   signal(SIGPIPE, SIG_IGN);
 
@@ -96,12 +144,21 @@ void loopcore::init(loopcore::core_error_handler_t herr,
   core_fd_ = epoll_create1(0);
   core_vars_ = calloc(CO_MAX_SO_EVENTS, sizeof(core_event_t));
   core_data_ = cached_fd_event_t();
+
+  // Signals added before the loop starts
+  if (signal_fd_ != -1) {
+    this->add_read_event(signal_fd_);
+  }
+  // The interrupt fd set before the loop starts
+  if (interrupt_fd_ != -1) {
+    __core_event_ctl__(core_fd_, (int)interrupt_fd_, EPOLLIN, EPOLL_CTL_ADD);
+  }
 }
 
 /**
- * @brief Block and wait for all fd
+ * @brief Block and wait for all fd, return the count of events, -1 on error
  */
-void loopcore::wait(duration_t duration) {
+int loopcore::wait(duration_t duration) {
   cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
 
   auto begin = TASK_TIME_NOW();
@@ -111,57 +168,59 @@ void loopcore::wait(duration_t duration) {
   time_waited_ += (TASK_TIME_NOW() - begin).count();
   
   // Already stopped
-  if (count == -1) return;
+  if (count == -1) return -1;
 
   for (int i = 0; i < count; ++i) {
     core_event_t* process_event = reinterpret_cast<core_event_t*>(core_vars_) + i;
     long fd = process_event->data.fd;
 
+    // The signalfd keeps monitoring, drain it until EAGAIN
+    if (fd == signal_fd_) {
+      struct signalfd_siginfo info;
+      while (read(signal_fd_, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        if (on_signal_) on_signal_((int)info.ssi_signo);
+      }
+      continue;
+    }
+    // The interrupt fd keeps readable, nothing to read
+    if (fd == interrupt_fd_) {
+      interrupted_ = true;
+      continue;
+    }
+    uint8_t& flag = __cached_event__(p_cache, fd);
+
+    // Error queue messages of a connected fd
+    bool errqueue = (
+      (process_event->events & EPOLLERR) &&
+      !(process_event->events & EPOLLHUP) &&
+      (flag & EPOLL_FD_ERROR_EVENT)
+    );
     // Check if is on error
-    auto c_it = p_cache->find(fd);
-    if ((process_event->events & EPOLLHUP) || (process_event->events & EPOLLERR)) {
-      if (c_it != p_cache->end()) {
-        uint32_t events = 0;
-        if (c_it->second & EPOLL_FD_READ_EVENT) {
-          events &= EPOLLIN;
-        }
-        if (c_it->second & EPOLL_FD_WRITE_EVENT) {
-          events &= EPOLLOUT;
-        }
+    if (!errqueue && ((process_event->events & EPOLLHUP) || (process_event->events & EPOLLERR))) {
+      if (flag & EPOLL_FD_REGISTERED) {
         // remove the event
-        __core_event_ctl__(core_fd_, fd, events, EPOLL_CTL_DEL);
-        // remove from cache
-        p_cache->erase(c_it);
+        __core_event_ctl__(core_fd_, fd, 0, EPOLL_CTL_DEL);
       }
+      flag = EPOLL_FD_NO_EVENT;
       if (on_error_) on_error_(fd);
     } else {
+      // Reported events are not monitored anymore until someone adds
+      // them again, the fd stays in the epoll set to save the syscalls
+      if (process_event->events & EPOLLIN) flag = __UNMARK_READ__(flag);
+      if (process_event->events & EPOLLOUT) flag = __UNMARK_WRITE__(flag);
+      // The error event keeps monitoring until deleted
+      if (errqueue && on_event_) {
+        on_event_(fd, kEventTypeError);
+      }
       if ((process_event->events & EPOLLIN) && on_event_) {
-        if (c_it != p_cache->end()) {
-          c_it->second = __UNMARK_READ__(c_it->second);
-        }
         on_event_(fd, kEventTypeRead);
       }
       if ((process_event->events & EPOLLOUT) && on_event_) {
-        if (c_it != p_cache->end()) {
-          c_it->second = __UNMARK_WRITE__(c_it->second);
-        }
         on_event_(fd, kEventTypeWrite);
       }
-      // Put the un reported event back to the epoll list
-      // or just remove the cache
-      if (c_it != p_cache->end()) {
-        if (c_it->second == EPOLL_FD_NO_EVENT) {
-          p_cache->erase(c_it);
-        } else if (c_it->second == EPOLL_FD_READ_EVENT) {
-          __core_event_ctl__(core_fd_, fd, EPOLLIN | EPOLLET, EPOLL_CTL_ADD);
-        } else if (c_it->second == EPOLL_FD_WRITE_EVENT) {
-          __core_event_ctl__(core_fd_, fd, EPOLLOUT | EPOLLET, EPOLL_CTL_ADD);
-        } else {
-          assert(false);
-        }
-      }
     }
   }
+  return count;
 }
 
 /**s
@@ -184,28 +243,19 @@ void loopcore::stop() {
  */
 bool loopcore::add_read_event(long fd) {
   cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
-  auto c_it = p_cache->find(fd);
+  uint8_t& flag = __cached_event__(p_cache, fd);
   // Already monite on read event
-  if (c_it != p_cache->end() && (c_it->second & EPOLL_FD_READ_EVENT)) {
-    return false;
-  }
-  uint32_t event = EPOLLIN | EPOLLET;
-  if (c_it != p_cache->end() && (c_it->second & EPOLL_FD_WRITE_EVENT)) {
-    event |= EPOLLOUT;
-  }
-  c_it->second = __MARK_READ__(c_it->second);
-  return (__core_event_ctl__(core_fd_, fd, event, EPOLL_CTL_ADD) > 0);
+  if (flag & EPOLL_FD_READ_EVENT) return false;
+  flag = __MARK_READ__(flag);
+  return (__core_event_apply__(core_fd_, fd, flag) == 0);
 }
 void loopcore::del_read_event(long fd) {
   cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
-  auto c_it = p_cache->find(fd);
+  uint8_t& flag = __cached_event__(p_cache, fd);
   // not monited
-  if (c_it == p_cache->end()) return;
-  __core_event_ctl__(core_fd_, fd, EPOLLIN, EPOLL_CTL_DEL);
-  c_it->second = __UNMARK_READ__(c_it->second);
-  if (c_it->second == EPOLL_FD_NO_EVENT) {
-    p_cache->erase(c_it);
-  }
+  if (!(flag & EPOLL_FD_READ_EVENT)) return;
+  flag = __UNMARK_READ__(flag);
+  __core_event_apply__(core_fd_, fd, flag);
 }
 
 /**
@@ -213,30 +263,95 @@ void loopcore::del_read_event(long fd) {
  */
 bool loopcore::add_write_event(long fd) {
   cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
-  auto c_it = p_cache->find(fd);
+  uint8_t& flag = __cached_event__(p_cache, fd);
   // Already monite on write event
-  if (c_it != p_cache->end() && (c_it->second & EPOLL_FD_WRITE_EVENT)) {
-    return false;
-  }
-  uint32_t event = EPOLLOUT | EPOLLET;
-  if (c_it != p_cache->end() && (c_it->second & EPOLL_FD_READ_EVENT)) {
-    event |= EPOLLIN;
-  }
-  c_it->second = __MARK_WRITE__(c_it->second);
-  return (__core_event_ctl__(core_fd_, fd, event, EPOLL_CTL_ADD) > 0);
+  if (flag & EPOLL_FD_WRITE_EVENT) return false;
+  flag = __MARK_WRITE__(flag);
+  return (__core_event_apply__(core_fd_, fd, flag) == 0);
 }
 void loopcore::del_write_event(long fd) {
   cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
-  auto c_it = p_cache->find(fd);
+  uint8_t& flag = __cached_event__(p_cache, fd);
   // not monited
-  if (c_it == p_cache->end()) return;
-  __core_event_ctl__(core_fd_, fd, EPOLLOUT, EPOLL_CTL_DEL);
-  c_it->second = __UNMARK_WRITE__(c_it->second);
-  if (c_it->second == EPOLL_FD_NO_EVENT) {
-    p_cache->erase(c_it);
+  if (!(flag & EPOLL_FD_WRITE_EVENT)) return;
+  flag = __UNMARK_WRITE__(flag);
+  __core_event_apply__(core_fd_, fd, flag);
+}
+
+/**
+ * @brief Process the error queue event, once added the error queue
+ * messages are not taken as a broken fd until deleted
+*/
+bool loopcore::add_error_event(long fd) {
+  cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
+  uint8_t& flag = __cached_event__(p_cache, fd);
+  if (flag & EPOLL_FD_ERROR_EVENT) return true;
+  flag |= EPOLL_FD_ERROR_EVENT;
+  return (__core_event_apply__(core_fd_, fd, flag) == 0);
+}
+void loopcore::del_error_event(long fd) {
+  cached_fd_event_t* p_cache = any_cast<cached_fd_event_t>(&core_data_);
+  uint8_t& flag = __cached_event__(p_cache, fd);
+  if (!(flag & EPOLL_FD_ERROR_EVENT)) return;
+  flag &= ~EPOLL_FD_ERROR_EVENT;
+  __core_event_apply__(core_fd_, fd, flag);
+}
+
+/**
+ * @brief Receive the signal in the core instead of the default action
+*/
+bool loopcore::add_signal(int signo) {
+  if (signo < 1 || signo > 64) return false;
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, signo);
+  if (0 != pthread_sigmask(SIG_BLOCK, &set, NULL)) return false;
+  __core_signal_set__(signal_mask_ | (1ull << (signo - 1)), &set);
+  int sfd = signalfd((int)signal_fd_, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (sfd == -1) return false;
+  signal_mask_ |= (1ull << (signo - 1));
+  if (signal_fd_ == -1) {
+    signal_fd_ = sfd;
+    if (core_fd_ != -1) this->add_read_event(signal_fd_);
+  }
+  return true;
+}
+void loopcore::del_signal(int signo) {
+  if (signo < 1 || signo > 64) return;
+  if (!(signal_mask_ & (1ull << (signo - 1)))) return;
+  signal_mask_ &= ~(1ull << (signo - 1));
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, signo);
+  pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+  if (signal_mask_ != 0) {
+    __core_signal_set__(signal_mask_, &set);
+    ignore_result(signalfd((int)signal_fd_, &set, SFD_NONBLOCK | SFD_CLOEXEC));
+    return;
+  }
+  if (core_fd_ != -1) this->del_read_event(signal_fd_);
+  close(signal_fd_);
+  signal_fd_ = -1;
+}
+
+/**
+ * @brief Watch the fd written by other threads to interrupt the loop,
+ * the fd is owned by the caller
+ */
+void loopcore::set_interrupt_fd(long fd) {
+  interrupt_fd_ = fd;
+  if (core_fd_ != -1) {
+    __core_event_ctl__(core_fd_, (int)interrupt_fd_, EPOLLIN, EPOLL_CTL_ADD);
   }
 }
 
+/**
+ * @brief Tell if the interrupt fd has become readable
+ */
+bool loopcore::interrupted() const {
+  return interrupted_;
+}
+
 /**
  * @brief Get all time cost on waiting
 */
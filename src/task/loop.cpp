@@ -45,11 +45,43 @@ task loop::run(worker_t worker, const char* name) {
   loopimpl::shared().add_task(inner_task);
   return task(inner_task->task_id());
 }
+/**
+ * @brief Start a task for each worker, all tasks are created in bulk
+ * and put into the ready queue at once
+*/
+std::vector<task> loop::run_batch(std::vector<worker_t>&& workers, const char* name) {
+  auto inner_tasks = basic_task::create_tasks(std::move(workers));
+  std::vector<task> result;
+  result.reserve(inner_tasks.size());
+  for (const auto& inner_task : inner_tasks) {
+    inner_task->set_name(name);
+    result.emplace_back(inner_task->task_id());
+  }
+  loopimpl::shared().add_ready_tasks(inner_tasks);
+  return result;
+}
 /**
  * @brief Start a loop task
 */
 task loop::run_loop(worker_t worker, duration_t interval, const char* name) {
-  auto inner_task = basic_task::create_task(worker, REPEAT_COUNT_INFINITIVE, interval);
+  return this->run_loop(worker, interval, kRepeatModeReset, name);
+}
+/**
+ * @brief Start a loop task in the given repeat mode
+*/
+task loop::run_loop(worker_t worker, duration_t interval, RepeatMode mode, const char* name) {
+  std::shared_ptr<basic_task> inner_task;
+  if (mode == kRepeatModePersistent) {
+    // A oneshot task which never returns until been cancelled
+    inner_task = basic_task::create_task([worker]() {
+      auto self = basic_task::running_task();
+      do {
+        worker();
+      } while (loopimpl::shared().park_until_next_fire(self));
+    }, REPEAT_COUNT_ONESHOT, interval);
+  } else {
+    inner_task = basic_task::create_task(worker, REPEAT_COUNT_INFINITIVE, interval);
+  }
   inner_task->set_name(name);
   // put the new task into the loop wrapper's timed list
   loopimpl::shared().add_task(inner_task);
@@ -66,6 +98,50 @@ task loop::run_delay(worker_t worker, duration_t delay, const char* name) {
   return task(inner_task->task_id());
 }
 
+/**
+ * @brief Invoke the worker once after given <delay> on the main context,
+ * no task or stack will be created. The worker must not block.
+*/
+timer loop::call_later(worker_t worker, duration_t delay) {
+  return timer(loopimpl::shared().add_timer(std::move(worker), delay, delay, false));
+}
+/**
+ * @brief Invoke the worker every <interval> on the main context until
+ * the timer is cancelled. The worker must not block.
+*/
+timer loop::call_every(worker_t worker, duration_t interval) {
+  return timer(loopimpl::shared().add_timer(std::move(worker), interval, interval, true));
+}
+/**
+ * @brief Invoke the worker once on the main context when the loop has
+ * run all ready tasks and is about to wait for events, used to coalesce
+ * work of a scheduler pass. The worker must not block.
+*/
+void loop::call_before_idle(worker_t worker) {
+  loopimpl::shared().add_idle_hook(std::move(worker));
+}
+
+/**
+ * @brief Take the fd's error queue messages as kEventTypeError instead
+ * of breaking its waiters, until released. Only on Linux
+*/
+bool loop::watch_fd_errors(long fd) {
+  return loopimpl::shared().add_error_event(fd);
+}
+void loop::release_fd_errors(long fd) {
+  loopimpl::shared().del_error_event(fd);
+}
+
+/**
+ * @brief Handle the signal inside the loop, the handler runs as a
+ * normal task each time the signal arrives. A null handler restores
+ * the default action. Call it before starting other threads, so the
+ * signal is not delivered to them. Handlers do not keep the loop alive.
+*/
+bool loop::on_signal(int signo, signal_handler_t handler) {
+  return loopimpl::shared().set_signal_handler(signo, handler);
+}
+
 /**
  * @brief Entrypoint of current loop, will block current thread
 */
@@ -81,6 +157,71 @@ int loop::main() {
 double loop::load_average() const {
   return loopimpl::shared().load_average();
 }
+/**
+ * @brief Get the total running time of tasks in given priority class
+*/
+duration_t loop::priority_time(TaskPriority priority) const {
+  return loopimpl::shared().priority_time(priority);
+}
+/**
+ * @brief Spin for new events with zero timeout before going to sleep,
+ * the spin budget tunes itself and never exceeds <max_budget>.
+ * Zero to disable, which is the default.
+*/
+void loop::set_busy_poll(duration_t max_budget) {
+  loopimpl::shared().set_busy_poll(max_budget);
+}
+/**
+ * @brief Get the total time spent on busy-polling, which is counted
+ * as idle time in load_average
+*/
+duration_t loop::busy_poll_time() const {
+  return loopimpl::shared().busy_poll_time();
+}
+
+/**
+ * @brief Switch the loop's clock, must be invoked before main.
+ * In virtual mode the loop jumps straight to the next timed task
+ * when idle instead of sleeping, so hours of timers run in
+ * milliseconds. Virtual time starts at the current steady time.
+*/
+bool loop::set_clock_mode(ClockMode mode) {
+  return loopimpl::shared().set_clock_mode(mode);
+}
+
+/**
+ * @brief Get the loop's clock mode
+*/
+ClockMode loop::clock_mode() const {
+  return task_clock::mode();
+}
+
+/**
+ * @brief Get current time of the loop's clock
+*/
+task_time_t loop::now() const {
+  return TASK_TIME_NOW();
+}
+
+/**
+ * @brief Dump all tasks of the loop, one line per task: id, name,
+ * parent, status, what the task is waiting for, time since its last
+ * run and the deepest stack usage observed when it yields, which
+ * misses deeper frames returned before a suspension point
+*/
+std::string loop::dump_tasks() const {
+  return loopimpl::shared().dump_tasks();
+}
+
+/**
+ * @brief Invoke in a task to shutdown gracefully: cancel all listeners,
+ * wait other tasks to finish until the <deadline>, then cancel the rest
+ * and drop all timers.
+ * @return the count of tasks been force cancelled
+*/
+size_t loop::drain(duration_t deadline) {
+  return loopimpl::shared().drain(deadline);
+}
 
 /**
  * @brief Invoke in any task, which will case current loop to break and return from main
@@ -35,6 +35,9 @@ SOFTWARE.
 #define PECO_LOOP_H__
 
 #include "task/task.h"
+#include "task/timer.h"
+
+#include <vector>
 
 namespace peco {
 
@@ -48,10 +51,66 @@ public:
    * @brief Start a loop task
   */
   task run_loop(worker_t worker, duration_t interval, const char* name = nullptr);
+  /**
+   * @brief Start a loop task in the given repeat mode
+  */
+  task run_loop(worker_t worker, duration_t interval, RepeatMode mode, const char* name = nullptr);
   /**
    * @brief Start a task after given <delay>
   */
   task run_delay(worker_t worker, duration_t delay, const char* name = nullptr);
+  /**
+   * @brief Start a task for each worker, all tasks are created in bulk
+   * and put into the ready queue at once
+  */
+  std::vector<task> run_batch(std::vector<worker_t>&& workers, const char* name = nullptr);
+  /**
+   * @brief Start a task for each element in [begin, end) which invokes
+   * fn(element), the element is copied into its task
+  */
+  template <typename Iterator, typename Function>
+  std::vector<task> run_batch(Iterator begin, Iterator end, Function fn, const char* name = nullptr) {
+    std::vector<worker_t> workers;
+    for (auto it = begin; it != end; ++it) {
+      auto element = *it;
+      workers.emplace_back([fn, element]() { fn(element); });
+    }
+    return this->run_batch(std::move(workers), name);
+  }
+
+public:
+  /**
+   * @brief Invoke the worker once after given <delay> on the main context,
+   * no task or stack will be created. The worker must not block.
+  */
+  timer call_later(worker_t worker, duration_t delay);
+  /**
+   * @brief Invoke the worker every <interval> on the main context until
+   * the timer is cancelled. The worker must not block.
+  */
+  timer call_every(worker_t worker, duration_t interval);
+  /**
+   * @brief Invoke the worker once on the main context when the loop has
+   * run all ready tasks and is about to wait for events, used to coalesce
+   * work of a scheduler pass. The worker must not block.
+  */
+  void call_before_idle(worker_t worker);
+
+  /**
+   * @brief Take the fd's error queue messages as kEventTypeError instead
+   * of breaking its waiters, until released. Only on Linux
+  */
+  bool watch_fd_errors(long fd);
+  void release_fd_errors(long fd);
+
+public:
+  /**
+   * @brief Handle the signal inside the loop, the handler runs as a
+   * normal task each time the signal arrives. A null handler restores
+   * the default action. Call it before starting other threads, so the
+   * signal is not delivered to them. Handlers do not keep the loop alive.
+  */
+  bool on_signal(int signo, signal_handler_t handler);
 
 public:
   /**
@@ -64,12 +123,64 @@ public:
   */
   double load_average() const;
 
+  /**
+   * @brief Get the total running time of tasks in given priority class
+  */
+  duration_t priority_time(TaskPriority priority) const;
+
+  /**
+   * @brief Spin for new events with zero timeout before going to sleep,
+   * the spin budget tunes itself and never exceeds <max_budget>.
+   * Zero to disable, which is the default.
+  */
+  void set_busy_poll(duration_t max_budget);
+
+  /**
+   * @brief Get the total time spent on busy-polling, which is counted
+   * as idle time in load_average
+  */
+  duration_t busy_poll_time() const;
+
+  /**
+   * @brief Switch the loop's clock, must be invoked before main.
+   * In virtual mode the loop jumps straight to the next timed task
+   * when idle instead of sleeping, so hours of timers run in
+   * milliseconds. Virtual time starts at the current steady time.
+  */
+  bool set_clock_mode(ClockMode mode);
+
+  /**
+   * @brief Get the loop's clock mode
+  */
+  ClockMode clock_mode() const;
+
+  /**
+   * @brief Get current time of the loop's clock
+  */
+  task_time_t now() const;
+
+  /**
+   * @brief Dump all tasks of the loop, one line per task: id, name,
+   * parent, status, what the task is waiting for, time since its last
+   * run and the deepest stack usage observed when it yields, which
+   * misses deeper frames returned before a suspension point
+  */
+  std::string dump_tasks() const;
+
 public:
   /**
    * @brief Invoke in any task, which will case current loop to break and return from main
   */
   void exit(int code = 0);
 
+  /**
+   * @brief Invoke in a task to shutdown gracefully: cancel all listeners,
+   * wait other tasks to finish until the <deadline>, then cancel the rest
+   * and drop all timers.
+   * @return the count of tasks been force cancelled
+  */
+  size_t drain(duration_t deadline);
+
 public:
   /**
    * @brief Get current thread's shared loop object
@@ -91,6 +91,7 @@ injector::injector() {
       loopimpl::shared().wait_for_reading(io_read, this_task, PECO_TIME_S(1));
       if (this_task->signal() == kWaitingSignalNothing) {
         // timedout, no incoming command, continue
+        if (this_task->deadline_exceeded()) break;
         continue;
       }
       if (this_task->signal() == kWaitingSignalReceived) {
@@ -126,7 +127,7 @@ injector::injector() {
     if (this_task->cancelled()) {
       int ret = 0;
       fd_set fs;
-      while (ret == 0) {
+      while (true) {
         struct timeval tv = {0, 0};
         do {
           FD_ZERO(&fs);
@@ -139,11 +140,14 @@ injector::injector() {
           break;
         }
         int l = read(io_read, &ij, sizeof(ij));
+        // All writers are gone
+        if (l != (int)sizeof(ij)) break;
+        // Never run, drop the worker
+        if (ij.p_worker) {
+          delete ij.p_worker;
+        }
         if (ij.io_out != -1 && (ij.timedout == -1 || TASK_TIME_NOW().time_since_epoch().count() < ij.timedout)) {
           // finished running, -1 means cancelled
-          if (ij.p_worker) {
-            delete ij.p_worker;
-          }
           l = -1;
           ignore_result(write(ij.io_out, &l, sizeof(int)));
         }
@@ -153,13 +157,12 @@ injector::injector() {
     close(io_read);
   });
   t->set_name(PECO_CODE_LOCATION);
+  // Injections are new work, stop accepting them when draining
+  t->set_listener(true);
   ij_task_ = t->task_id();
   loopimpl::shared().add_task(t);
   t->set_atexit([this]() {
-    if (this->io_write_ == -1) return;
-    int w = this->io_write_;
-    this->io_write_ = -1;
-    close(w);
+    ignore_result(this->close_pipe_());
   });
 }
 /**
@@ -172,7 +175,7 @@ injector::~injector() {
   * @brief Disable current injector
 */
 void injector::disable() {
-  if (io_write_ == -1) return;
+  if (!this->is_enabled()) return;
   // cancel ij task
   auto ij_tid = ij_task_;
   ij_task_ = kInvalidateTaskId;
@@ -181,19 +184,42 @@ void injector::disable() {
     loopimpl::shared().cancel(t);
   });
   // close write pipe
+  ignore_result(this->close_pipe_());
+}
+
+/**
+ * @brief Tell if the injector still accepts injections
+*/
+bool injector::is_enabled() const {
+  return io_write_ != -1;
+}
+
+/**
+ * @brief Write to the pipe, return false if the injector is disabled
+*/
+bool injector::write_pipe_(const void* data, size_t length) const {
+  std::lock_guard<std::mutex> _(io_lock_);
   int w = io_write_;
-  io_write_ = -1;
+  if (w == -1) return false;
+  ignore_result(write(w, data, length));
+  return true;
+}
+
+/**
+ * @brief Close the write pipe, return false if it has been closed
+*/
+bool injector::close_pipe_() {
+  std::lock_guard<std::mutex> _(io_lock_);
+  int w = io_write_.exchange(-1);
+  if (w == -1) return false;
   close(w);
+  return true;
 }
 
 /**
  * @brief block current task/thread to inject the worker
 */
 bool injector::sync_inject(worker_t worker, const char* name) const {
-  if (io_write_ == -1) {
-    log::alert << "async_inject on a disabled inject" << std::endl;
-    return false;
-  }
   std::shared_ptr<pipe_wrapper_t> ij_io(new pipe_wrapper_t, [](pipe_wrapper_t * pw) {
     if (pw->p[0] != -1) {
       close(pw->p[0]);
@@ -212,7 +238,11 @@ bool injector::sync_inject(worker_t worker, const char* name) const {
   ij.io_out = ij_io->p[1];
 
   // write to the pipe
-  ignore_result(write(io_write_, (void *)&ij, sizeof(ij)));
+  if (!this->write_pipe_((void *)&ij, sizeof(ij))) {
+    delete ij.p_worker;
+    log::alert << "inject on a disabled injector" << std::endl;
+    return false;
+  }
 
   // Wait for the injection done
   auto _this_task = basic_task::running_task();
@@ -246,10 +276,6 @@ bool injector::sync_inject(worker_t worker, const char* name) const {
  * @brief block current task/thread until the 'timedout'
 */
 bool injector::inject_wait(worker_t worker, duration_t timedout, const char* name) const {
-  if (io_write_ == -1) {
-    log::alert << "async_inject on a disabled inject" << std::endl;
-    return false;
-  }
   std::shared_ptr<pipe_wrapper_t> ij_io(new pipe_wrapper_t, [](pipe_wrapper_t * pw) {
     if (pw->p[0] != -1) {
       close(pw->p[0]);
@@ -270,7 +296,11 @@ bool injector::inject_wait(worker_t worker, duration_t timedout, const char* nam
   ij.io_out = ij_io->p[1];
 
   // write to the pipe
-  ignore_result(write(io_write_, (void *)&ij, sizeof(ij)));
+  if (!this->write_pipe_((void *)&ij, sizeof(ij))) {
+    delete ij.p_worker;
+    log::alert << "inject on a disabled injector" << std::endl;
+    return false;
+  }
 
   // Wait for the injection done
   auto _this_task = basic_task::running_task();
@@ -299,10 +329,6 @@ bool injector::inject_wait(worker_t worker, duration_t timedout, const char* nam
  * @brief just inject the worker and ignore the response
 */
 void injector::async_inject(worker_t worker, const char* name) const {
-  if (io_write_ == -1) {
-    log::alert << "async_inject on a disabled inject" << std::endl;
-    return;
-  }
   InjectorInfo ij;
   ij.p_worker = new worker_t(worker);
   ij.name = name;
@@ -310,7 +336,10 @@ void injector::async_inject(worker_t worker, const char* name) const {
   ij.io_out = -1;
 
   // write to the pipe
-  ignore_result(write(io_write_, (void *)&ij, sizeof(ij)));
+  if (!this->write_pipe_((void *)&ij, sizeof(ij))) {
+    delete ij.p_worker;
+    log::alert << "async_inject on a disabled inject" << std::endl;
+  }
 }
 
 } // namespace shared
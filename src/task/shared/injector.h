@@ -38,6 +38,7 @@ SOFTWARE.
 #include "task/taskdef.h"
 
 #include <atomic>
+#include <mutex>
 
 namespace peco {
 namespace shared {
@@ -67,6 +68,11 @@ public:
   */
   void disable();
 
+  /**
+   * @brief Tell if the injector still accepts injections
+  */
+  bool is_enabled() const;
+
 public:
   /**
    * @brief block current task/thread to inject the worker
@@ -84,6 +90,19 @@ public:
   */
   void async_inject(worker_t worker, const char* name = nullptr) const;
 protected:
+  /**
+   * @brief Write to the pipe, return false if the injector is disabled
+  */
+  bool write_pipe_(const void* data, size_t length) const;
+
+  /**
+   * @brief Close the write pipe, return false if it has been closed
+  */
+  bool close_pipe_();
+protected:
+  // Orders writing and closing, the loop thread closes the pipe while
+  // other threads write to it. Reading the fd alone needs no lock
+  mutable std::mutex io_lock_;
   std::atomic<int> io_write_;
   task_id_t ij_task_;
 };
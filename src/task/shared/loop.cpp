@@ -30,6 +30,8 @@ SOFTWARE.
 */
 
 #include "task/shared/loop.h"
+#include "task/impl/basictask.hxx"
+#include "task/impl/loopimpl.hxx"
 
 #include <thread>
 
@@ -51,7 +53,10 @@ std::shared_ptr<loop> loop::gcontext() {
 loop::loop() {
   int ij_pipe[2];
   ignore_result(pipe(ij_pipe));
+  ignore_result(pipe(exit_pipe_));
   lt_ = new std::thread([&]() {
+    // Still able to exit when the injector is disabled
+    loopimpl::shared().set_interrupt_fd(exit_pipe_[0]);
     auto ij = std::make_shared<injector>();
     this->ij_ = ij;
     int flag = 0;
@@ -78,15 +83,27 @@ loop::loop() {
 }
 
 loop::~loop() {
+  bool injected = false;
   if (auto ij = ij_.lock()) {
-    ij->async_inject([]() {
-      peco::loop::shared()->exit(0);
-    });
+    if (ij->is_enabled()) {
+      ij->async_inject([]() {
+        peco::loop::shared()->exit(0);
+      });
+      injected = true;
+    }
+  }
+  // The injector has been disabled if the loop was drained, interrupt
+  // the loop directly in case anything left keeps it running
+  if (!injected) {
+    char flag = 0;
+    ignore_result(write(exit_pipe_[1], &flag, sizeof(flag)));
   }
   if (lt_->joinable()) {
     lt_->join();
   }
   delete lt_;
+  close(exit_pipe_[0]);
+  close(exit_pipe_[1]);
 }
 
 /**
@@ -94,27 +111,37 @@ loop::~loop() {
 */
 peco::shared::task loop::run(worker_t worker, const char* name) {
   task_id_t tid = kInvalidateTaskId;
+  std::shared_ptr<task_snapshot> snapshot;
   if (auto ij = ij_.lock()) {
     ij->inject_wait([&]() {
       auto t = peco::loop::shared()->run(worker, name);
       tid = t.task_id();
+      snapshot = basic_task::fetch(tid)->snapshot();
     }, PECO_TIME_S(1), name);
   }
-  return peco::shared::task(this->shared_from_this(), tid);
+  return peco::shared::task(this->shared_from_this(), tid, snapshot);
 }
 
 /**
  * @brief Post a 'run_loop' command to the shared loop
 */
 peco::shared::task loop::run_loop(worker_t worker, duration_t interval, const char* name) {
+  return this->run_loop(worker, interval, kRepeatModeReset, name);
+}
+/**
+ * @brief Post a 'run_loop' command with the given repeat mode to the shared loop
+*/
+peco::shared::task loop::run_loop(worker_t worker, duration_t interval, RepeatMode mode, const char* name) {
   task_id_t tid = kInvalidateTaskId;
+  std::shared_ptr<task_snapshot> snapshot;
   if (auto ij = ij_.lock()) {
     ij->inject_wait([&]() {
-      auto t = peco::loop::shared()->run_loop(worker, interval, name);
+      auto t = peco::loop::shared()->run_loop(worker, interval, mode, name);
       tid = t.task_id();
+      snapshot = basic_task::fetch(tid)->snapshot();
     }, PECO_TIME_S(1), name);
   }
-  return peco::shared::task(this->shared_from_this(), tid);
+  return peco::shared::task(this->shared_from_this(), tid, snapshot);
 }
 
 /**
@@ -122,13 +149,15 @@ peco::shared::task loop::run_loop(worker_t worker, duration_t interval, const ch
 */
 peco::shared::task loop::run_delay(worker_t worker, duration_t delay, const char* name) {
   task_id_t tid = kInvalidateTaskId;
+  std::shared_ptr<task_snapshot> snapshot;
   if (auto ij = ij_.lock()) {
     ij->inject_wait([&]() {
       auto t = peco::loop::shared()->run_delay(worker, delay, name);
       tid = t.task_id();
+      snapshot = basic_task::fetch(tid)->snapshot();
     }, PECO_TIME_S(1), name);
   }
-  return peco::shared::task(this->shared_from_this(), tid);
+  return peco::shared::task(this->shared_from_this(), tid, snapshot);
 }
 
 /**
@@ -170,6 +199,38 @@ void loop::exit(int code) {
     });
   }
 }
+/**
+ * @brief Pin the loop's thread to given cpus, return false if not supported
+*/
+bool loop::set_affinity(const std::vector<int>& cpus) {
+#if PECO_TARGET_LINUX
+  if (cpus.size() == 0) return false;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &cpu_set);
+  }
+  return (pthread_setaffinity_np(lt_->native_handle(), sizeof(cpu_set), &cpu_set) == 0);
+#else
+  ignore_result(cpus);
+  return false;
+#endif
+}
+
+/**
+ * @brief Drain the shared loop and block until it is done, the loop
+ * stops accepting injections and exits after the draining.
+ * @return the count of tasks been force cancelled
+*/
+size_t loop::drain(duration_t deadline) {
+  size_t forced = 0;
+  this->sync_inject([&forced, deadline]() {
+    forced = peco::loop::shared()->drain(deadline);
+  });
+  return forced;
+}
+
 /**
  * @brief Get current loop's load average
 */
@@ -181,6 +242,37 @@ double loop::load_average() const {
   return la;
 }
 
+/**
+ * @brief Enable busy-polling on the shared loop, zero to disable
+*/
+void loop::set_busy_poll(duration_t max_budget) {
+  this->sync_inject([max_budget]() {
+    peco::loop::shared()->set_busy_poll(max_budget);
+  });
+}
+
+/**
+ * @brief Get the total time the shared loop spent on busy-polling
+*/
+duration_t loop::busy_poll_time() const {
+  duration_t t = duration_t::zero();
+  this->sync_inject([&t]() {
+    t = peco::loop::shared()->busy_poll_time();
+  });
+  return t;
+}
+
+/**
+ * @brief Dump all tasks of the shared loop, one line per task
+*/
+std::string loop::dump_tasks() const {
+  std::string dump;
+  this->sync_inject([&dump]() {
+    dump = peco::loop::shared()->dump_tasks();
+  });
+  return dump;
+}
+
 } // namespace shared
 } // namespace peco
 
@@ -40,6 +40,7 @@ SOFTWARE.
 #include "task/shared/injector.h"
 
 #include <thread>
+#include <vector>
 
 namespace peco {
 namespace shared {
@@ -70,6 +71,10 @@ public:
    * @brief Post a 'run_loop' command to the shared loop
   */
   peco::shared::task run_loop(worker_t worker, duration_t interval, const char* name = nullptr);
+  /**
+   * @brief Post a 'run_loop' command with the given repeat mode to the shared loop
+  */
+  peco::shared::task run_loop(worker_t worker, duration_t interval, RepeatMode mode, const char* name = nullptr);
 
   /**
    * @brief Post a 'run_delay' command to the shared loop
@@ -97,14 +102,42 @@ public:
    * @brief Get current loop's load average
   */
   double load_average() const;
+
+  /**
+   * @brief Enable busy-polling on the shared loop, zero to disable
+  */
+  void set_busy_poll(duration_t max_budget);
+
+  /**
+   * @brief Get the total time the shared loop spent on busy-polling
+  */
+  duration_t busy_poll_time() const;
+
+  /**
+   * @brief Dump all tasks of the shared loop, one line per task
+  */
+  std::string dump_tasks() const;
+
+  /**
+   * @brief Pin the loop's thread to given cpus, return false if not supported
+  */
+  bool set_affinity(const std::vector<int>& cpus);
   /**
    * @brief post `exit` command to the shared loop
   */
   void exit(int code = 0);
 
+  /**
+   * @brief Drain the shared loop and block until it is done, the loop
+   * stops accepting injections and exits after the draining.
+   * @return the count of tasks been force cancelled
+  */
+  size_t drain(duration_t deadline);
+
 protected:
   std::weak_ptr<injector> ij_;
   std::thread* lt_;
+  int exit_pipe_[2];
 };
 
 } // namespace shared
@@ -0,0 +1,183 @@
+/*
+    loopgroup.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/shared/loopgroup.h"
+#include "basic/sysinfo.h"
+#include "basic/logs.h"
+
+namespace peco {
+namespace shared {
+
+loop_group::loop_group(PlacementPolicy policy)
+  : policy_(policy), next_index_(0) { }
+
+loop_group::~loop_group() {
+  // all loops will exit in their d'stor
+}
+
+/**
+ * @brief Create a group with <count> loops, not pinned
+*/
+std::shared_ptr<loop_group> loop_group::create(size_t count, PlacementPolicy policy) {
+  auto group = std::shared_ptr<loop_group>(new loop_group(policy));
+  for (size_t i = 0; i < count; ++i) {
+    group->add_loop_(std::vector<int>());
+  }
+  return group;
+}
+
+/**
+ * @brief Create a group with one loop pinned to each given cpu
+*/
+std::shared_ptr<loop_group> loop_group::create_pinned(
+  const std::vector<int>& cpus, PlacementPolicy policy
+) {
+  auto group = std::shared_ptr<loop_group>(new loop_group(policy));
+  for (auto cpu : cpus) {
+    group->add_loop_(std::vector<int>{cpu});
+  }
+  return group;
+}
+
+/**
+ * @brief Create a group with <loops_per_node> loops on each given NUMA node,
+ * every loop is pinned to all cpus of its node
+*/
+std::shared_ptr<loop_group> loop_group::create_on_nodes(
+  const std::vector<int>& nodes, size_t loops_per_node, PlacementPolicy policy
+) {
+  auto group = std::shared_ptr<loop_group>(new loop_group(policy));
+  for (auto node : nodes) {
+    auto cpus = numa_node_cpus(node);
+    if (cpus.size() == 0) {
+      log::error << "no cpu found on NUMA node " << node << std::endl;
+    }
+    for (size_t i = 0; i < loops_per_node; ++i) {
+      group->add_loop_(cpus);
+    }
+  }
+  return group;
+}
+
+/**
+ * @brief Start a new loop and pin it to <cpus> if not empty
+*/
+void loop_group::add_loop_(const std::vector<int>& cpus) {
+  auto l = loop::create();
+  if (cpus.size() > 0 && !l->set_affinity(cpus)) {
+    log::error << "failed to pin loop " << loops_.size() << " to given cpus" << std::endl;
+  }
+  loops_.push_back(l);
+  loads_.push_back(std::make_shared<std::atomic<size_t>>(0));
+}
+
+/**
+ * @brief Post the worker as a new task to one loop, will not block
+*/
+void loop_group::submit(worker_t worker, const char* name) {
+  if (loops_.size() == 0) return;
+  this->submit_to(this->pick(), worker, name);
+}
+
+/**
+ * @brief Post the worker as a new task to the loop at <index>
+*/
+void loop_group::submit_to(size_t index, worker_t worker, const char* name) {
+  if (index >= loops_.size()) return;
+  auto load = loads_[index];
+  load->fetch_add(1, std::memory_order_relaxed);
+  // Give the load back when the last copy of the worker is gone, so a
+  // worker dropped without running does not hold it forever
+  std::shared_ptr<void> guard(nullptr, [load](void*) {
+    load->fetch_sub(1, std::memory_order_relaxed);
+  });
+  loops_[index]->async_inject([guard, worker]() {
+    worker();
+  }, name);
+}
+
+/**
+ * @brief Pick a loop index according to the placement policy
+*/
+size_t loop_group::pick() const {
+  if (loops_.size() == 0) return 0;
+  size_t start = next_index_.fetch_add(1, std::memory_order_relaxed) % loops_.size();
+  if (policy_ == kPlacementRoundRobin) return start;
+  // Least loaded, start from the round-robin index to break the tie
+  size_t picked = start;
+  size_t picked_load = loads_[start]->load(std::memory_order_relaxed);
+  for (size_t i = 1; i < loops_.size() && picked_load > 0; ++i) {
+    size_t index = (start + i) % loops_.size();
+    size_t l = loads_[index]->load(std::memory_order_relaxed);
+    if (l < picked_load) {
+      picked = index;
+      picked_load = l;
+    }
+  }
+  return picked;
+}
+
+/**
+ * @brief Get the loop count
+*/
+size_t loop_group::size() const {
+  return loops_.size();
+}
+
+/**
+ * @brief Get the loop at <index>
+*/
+std::shared_ptr<loop> loop_group::at(size_t index) const {
+  if (index >= loops_.size()) return nullptr;
+  return loops_[index];
+}
+
+/**
+ * @brief Get the submitted but not finished worker count of the loop at <index>
+*/
+size_t loop_group::load(size_t index) const {
+  if (index >= loads_.size()) return 0;
+  return loads_[index]->load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief post `exit` command to all loops
+*/
+void loop_group::exit(int code) {
+  for (auto& l : loops_) {
+    l->exit(code);
+  }
+}
+
+} // namespace shared
+} // namespace peco
+
+// Push Chen
@@ -0,0 +1,141 @@
+/*
+    loopgroup.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_SHARED_LOOPGROUP_H__
+#define PECO_SHARED_LOOPGROUP_H__
+
+#include "pecostd.h"
+#include "task/shared/loop.h"
+
+#include <atomic>
+#include <vector>
+
+namespace peco {
+namespace shared {
+
+/**
+ * @brief How to choose a loop when submitting a worker
+*/
+typedef enum {
+  /**
+   * @brief Pick loops one by one
+  */
+  kPlacementRoundRobin,
+  /**
+   * @brief Pick the loop with the least running submitted workers
+  */
+  kPlacementLeastLoaded
+} PlacementPolicy;
+
+class loop_group : public std::enable_shared_from_this<loop_group> {
+protected:
+  loop_group(PlacementPolicy policy);
+
+public:
+  ~loop_group();
+
+  /**
+   * @brief Create a group with <count> loops, not pinned
+  */
+  static std::shared_ptr<loop_group> create(
+    size_t count, PlacementPolicy policy = kPlacementLeastLoaded);
+
+  /**
+   * @brief Create a group with one loop pinned to each given cpu
+  */
+  static std::shared_ptr<loop_group> create_pinned(
+    const std::vector<int>& cpus, PlacementPolicy policy = kPlacementLeastLoaded);
+
+  /**
+   * @brief Create a group with <loops_per_node> loops on each given NUMA node,
+   * every loop is pinned to all cpus of its node
+  */
+  static std::shared_ptr<loop_group> create_on_nodes(
+    const std::vector<int>& nodes, size_t loops_per_node,
+    PlacementPolicy policy = kPlacementLeastLoaded);
+
+public:
+  /**
+   * @brief Post the worker as a new task to one loop, will not block
+  */
+  void submit(worker_t worker, const char* name = nullptr);
+
+  /**
+   * @brief Post the worker as a new task to the loop at <index>
+  */
+  void submit_to(size_t index, worker_t worker, const char* name = nullptr);
+
+  /**
+   * @brief Pick a loop index according to the placement policy
+  */
+  size_t pick() const;
+
+  /**
+   * @brief Get the loop count
+  */
+  size_t size() const;
+
+  /**
+   * @brief Get the loop at <index>
+  */
+  std::shared_ptr<loop> at(size_t index) const;
+
+  /**
+   * @brief Get the submitted but not finished worker count of the loop at <index>
+  */
+  size_t load(size_t index) const;
+
+  /**
+   * @brief post `exit` command to all loops
+  */
+  void exit(int code = 0);
+
+protected:
+  /**
+   * @brief Start a new loop and pin it to <cpus> if not empty
+  */
+  void add_loop_(const std::vector<int>& cpus);
+
+protected:
+  PlacementPolicy                                   policy_;
+  std::vector<std::shared_ptr<loop>>                loops_;
+  std::vector<std::shared_ptr<std::atomic<size_t>>> loads_;
+  mutable std::atomic<size_t>                       next_index_;
+};
+
+} // namespace shared
+} // namespace peco
+
+#endif
+
+// Push Chen
@@ -31,6 +31,7 @@ SOFTWARE.
 
 #include "task/shared/task.h"
 #include "task/shared/loop.h"
+#include "task/impl/basictask.hxx"
 
 namespace peco {
 namespace shared {
@@ -38,8 +39,8 @@ namespace shared {
 /**
  * @brief A Sharedtask cannot be created out of class loop
 */
-task::task(std::weak_ptr<loop> wloop, task_id_t tid)
-  :loop_(wloop), tid_(tid) { }
+task::task(std::weak_ptr<loop> wloop, task_id_t tid, std::shared_ptr<task_snapshot> snapshot)
+  :loop_(wloop), tid_(tid), snapshot_(snapshot) { }
 
 task::~task() {
 
@@ -48,22 +49,26 @@ task::~task() {
 /**
  * @brief Copy & Move
 */
-task::task(const task& other) : loop_(other.loop_), tid_(other.tid_) {
+task::task(const task& other)
+  : loop_(other.loop_), tid_(other.tid_), snapshot_(other.snapshot_) {
 
 }
-task::task(task&& other) : loop_(std::move(other.loop_)), tid_(other.tid_) {
+task::task(task&& other)
+  : loop_(std::move(other.loop_)), tid_(other.tid_), snapshot_(std::move(other.snapshot_)) {
   
 }
 task& task::operator= (const task& other) {
   if (this == &other) return *this;
   loop_ = other.loop_;
   tid_ = other.tid_;
+  snapshot_ = other.snapshot_;
   return *this;
 }
 task& task::operator= (task&& other) {
   if (this == &other) return *this;
   loop_ = std::move(other.loop_);
   tid_ = other.tid_;
+  snapshot_ = std::move(other.snapshot_);
   return *this;
 }
 
@@ -71,6 +76,9 @@ task& task::operator= (task&& other) {
  * @brief Check if the task ref is alive
 */
 bool task::is_alive() const {
+  if (snapshot_) {
+    return snapshot_->status() != kTaskStatusStopped;
+  }
   bool ret = false;
   if (auto l = loop_.lock()) {
     l->sync_inject([&]() {
@@ -91,6 +99,9 @@ task_id_t task::task_id() const {
  * @brief Get the task's status
 */
 TaskStatus task::status() const {
+  if (snapshot_) {
+    return snapshot_->status();
+  }
   TaskStatus status = kTaskStatusStopped;
   if (auto l = loop_.lock()) {
     l->sync_inject([&]() {
@@ -104,6 +115,9 @@ TaskStatus task::status() const {
  * @brief Get the last waiting signal
 */
 WaitingSignal task::signal() const {
+  if (snapshot_) {
+    return snapshot_->signal();
+  }
   WaitingSignal signal = kWaitingSignalBroken;
   if (auto l = loop_.lock()) {
     l->sync_inject([&]() {
@@ -131,6 +145,9 @@ worker_t task::set_atexit(worker_t fn_exit) {
  * @brief If current task is been cancelled
 */
 bool task::is_cancelled() const {
+  if (snapshot_) {
+    return snapshot_->cancelled();
+  }
   bool ret = false;
   if (auto l = loop_.lock()) {
     l->sync_inject([&]() {
@@ -190,13 +207,17 @@ void task::set_name(const char* name) {
  * @brief Get the task's name
 */
 const char* task::get_name() const {
-  const char * p_name = "";
+  if (snapshot_) {
+    name_ = snapshot_->name();
+    return name_.c_str();
+  }
+  name_.clear();
   if (auto l = loop_.lock()) {
     l->sync_inject([&]() {
-      p_name = peco::task(tid_).get_name();
+      name_ = peco::task(tid_).get_name();
     });
   }
-  return "";
+  return name_.c_str();
 }
 
 /**
@@ -209,7 +230,31 @@ peco::shared::task task::parent_task() const {
       pid = peco::task(tid_).parent_task().task_id();
     });
   }
-  return task(loop_, kInvalidateTaskId);
+  return task(loop_, pid);
+}
+
+/**
+ * @brief Set the task's priority class
+*/
+void task::set_priority(TaskPriority priority) {
+  if (auto l = loop_.lock()) {
+    l->sync_inject([=]() {
+      peco::task(tid_).set_priority(priority);
+    });
+  }
+}
+
+/**
+ * @brief Get the task's priority class
+*/
+TaskPriority task::priority() const {
+  TaskPriority priority = kTaskPriorityNormal;
+  if (auto l = loop_.lock()) {
+    l->sync_inject([&]() {
+      priority = peco::task(tid_).priority();
+    });
+  }
+  return priority;
 }
 
 /**
@@ -217,11 +262,24 @@ peco::shared::task task::parent_task() const {
  * all method will return immediately.
 */
 void task::cancel() {
-  if (auto l = loop_.lock()) {
-    l->sync_inject([=]() {
-      peco::task(tid_).cancel();
+  auto l = loop_.lock();
+  if (!l) return;
+  if (snapshot_) {
+    // Only ring the loop at the first request
+    if (!snapshot_->request_cancel()) return;
+    auto tid = tid_;
+    auto snapshot = snapshot_;
+    l->async_inject([tid, snapshot]() {
+      // The task id may have been reused by another task
+      auto ptrt = basic_task::fetch(tid);
+      if (ptrt == nullptr || ptrt->snapshot(false) != snapshot) return;
+      peco::task(tid).cancel();
     });
+    return;
   }
+  l->sync_inject([=]() {
+    peco::task(tid_).cancel();
+  });
 }
 /**
  * @brief Update a loop task's interval
@@ -37,6 +37,8 @@ SOFTWARE.
 #include "task/task.h"
 
 namespace peco {
+class task_snapshot;
+
 namespace shared {
 class loop;
 
@@ -48,9 +50,12 @@ protected:
   */
   friend class loop;
   /**
-   * @brief A task cannot be created out of class loop
+   * @brief A task cannot be created out of class loop.
+   * With a snapshot, status, signal, cancel flag and name can be read
+   * without injecting into the loop
   */
-  task(std::weak_ptr<loop> wloop, task_id_t tid);
+  task(std::weak_ptr<loop> wloop, task_id_t tid,
+    std::shared_ptr<task_snapshot> snapshot = nullptr);
 
 public:
   ~task();
@@ -125,9 +130,20 @@ public:
   */
   peco::shared::task parent_task() const;
 
+  /**
+   * @brief Set the task's priority class
+  */
+  void set_priority(TaskPriority priority);
+
+  /**
+   * @brief Get the task's priority class
+  */
+  TaskPriority priority() const;
+
   /**
    * @brief Mask the task to be cancelled
    * all method will return immediately.
+   * With a snapshot, this will not wait for the loop to process the request
   */
   void cancel();
   
@@ -139,6 +155,8 @@ public:
 protected:
   std::weak_ptr<loop> loop_;
   task_id_t tid_;
+  std::shared_ptr<task_snapshot> snapshot_;
+  mutable std::string name_;
 };
 
 } // namespace shared
@@ -188,6 +188,81 @@ task task::parent_task() const {
   if (rt == nullptr) return task(kInvalidateTaskId);
   return task(rt->parent_task());
 }
+
+/**
+ * @brief Set the task's priority class, ready tasks with higher
+ * priority will be scheduled first
+*/
+void task::set_priority(TaskPriority priority) {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return;
+  rt->set_priority(priority);
+}
+
+/**
+ * @brief Get the task's priority class
+*/
+TaskPriority task::priority() const {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return kTaskPriorityNormal;
+  return rt->priority();
+}
+
+/**
+ * @brief Mark the task as a listener which accepts new work,
+ * listeners are cancelled first when the loop is draining. A listener
+ * outlives any request, so the inherited deadline is dropped
+*/
+void task::set_listener(bool listener) {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return;
+  rt->set_listener(listener);
+}
+
+/**
+ * @brief Tell if the task is a listener
+*/
+bool task::is_listener() const {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return false;
+  return rt->is_listener();
+}
+
+/**
+ * @brief Set the deadline of the task, all timed waits of the task are
+ * clamped to it, and tasks created by this task inherit it.
+ * task_time_t::max() means no deadline
+*/
+void task::set_deadline(task_time_t deadline) {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return;
+  rt->set_deadline(deadline);
+}
+
+/**
+ * @brief Set the deadline to now + budget
+*/
+void task::set_timeout(duration_t budget) {
+  this->set_deadline(TASK_TIME_NOW() + budget);
+}
+
+/**
+ * @brief Get the deadline of the task
+*/
+task_time_t task::deadline() const {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return task_time_t::max();
+  return rt->deadline();
+}
+
+/**
+ * @brief Tell if the task's deadline has passed
+*/
+bool task::is_deadline_exceeded() const {
+  auto rt = basic_task::fetch(tid_);
+  if (rt == nullptr) return false;
+  return rt->deadline_exceeded();
+}
   
 /**
  * @brief Hold current task, yield, but not put back to the timed based cache
@@ -255,6 +330,8 @@ void task::wait_fd_for_event(long fd, EventType e, duration_t timedout) {
     loopimpl::shared().wait_for_reading(fd, rt, timedout);
   } else if (e == kEventTypeWrite) {
     loopimpl::shared().wait_for_writing(fd, rt, timedout);
+  } else if (e == kEventTypeError) {
+    loopimpl::shared().wait_for_errors(fd, rt, timedout);
   }
 }
 
@@ -270,6 +347,8 @@ void task::sleep(duration_t duration) {
     loopimpl::shared().hold_task_for(rt, duration);
     // If the task has been marked cancelled, break the sleep loop
     if (rt->cancelled()) break;
+    // Sleeping after the deadline wastes the task's budget
+    if (rt->deadline_exceeded()) break;
     auto now = TASK_TIME_NOW();
     if (now >= expect_end) break;
     duration = (expect_end - now);
@@ -140,6 +140,51 @@ public:
   */
   task parent_task() const;
 
+  /**
+   * @brief Set the task's priority class, ready tasks with higher
+   * priority will be scheduled first
+  */
+  void set_priority(TaskPriority priority);
+
+  /**
+   * @brief Get the task's priority class
+  */
+  TaskPriority priority() const;
+
+  /**
+   * @brief Mark the task as a listener which accepts new work,
+   * listeners are cancelled first when the loop is draining. A listener
+   * outlives any request, so the inherited deadline is dropped
+  */
+  void set_listener(bool listener = true);
+
+  /**
+   * @brief Tell if the task is a listener
+  */
+  bool is_listener() const;
+
+  /**
+   * @brief Set the deadline of the task, all timed waits of the task are
+   * clamped to it, and tasks created by this task inherit it.
+   * task_time_t::max() means no deadline
+  */
+  void set_deadline(task_time_t deadline);
+
+  /**
+   * @brief Set the deadline to now + budget
+  */
+  void set_timeout(duration_t budget);
+
+  /**
+   * @brief Get the deadline of the task
+  */
+  task_time_t deadline() const;
+
+  /**
+   * @brief Tell if the task's deadline has passed
+  */
+  bool is_deadline_exceeded() const;
+
 public:
   /**
    * @brief Hold current task, yield, but not put back to the timed based cache
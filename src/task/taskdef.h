@@ -50,21 +50,37 @@ enum {
   kInvalidateTaskId   = -1ll
 };
 
+/**
+ * @brief stackless timer id
+*/
+typedef int64_t timer_id_t;
+enum {
+  kInvalidateTimerId  = -1ll
+};
+
 /**
  * @brief time stamp
 */
 typedef std::chrono::steady_clock                 steady_clock_t;
 typedef std::chrono::time_point<steady_clock_t>   task_time_t;
 typedef std::chrono::nanoseconds                  duration_t;
-#define TASK_TIME_NOW   std::chrono::steady_clock::now
+#define TASK_TIME_NOW   peco::task_time_now
 #define PECO_TIME_S(x)      std::chrono::seconds(x)
 #define PECO_TIME_MS(x)     std::chrono::milliseconds(x)
+#define PECO_TIME_US(x)     std::chrono::microseconds(x)
 #define PECO_TIME_NS(x)     std::chrono::nanoseconds(x)
 
+/**
+ * @brief Current time of the loop clock in this thread, which is the
+ * steady clock unless the loop runs in virtual time
+*/
+task_time_t task_time_now();
+
 /**
  * @brief The wroker in the task
 */
 typedef std::function< void(void) >               worker_t;
+typedef std::function< void(int) >                signal_handler_t;
 
 #ifndef TASK_STACK_SIZE
 // Usually a 512KB Stack is enough for most programs
@@ -82,6 +98,17 @@ typedef std::function< void(void) >               worker_t;
 #endif
 #endif
 
+#ifndef PECO_TASK_STARVATION_LIMIT_MS
+// A ready task which has been waiting longer than this limit will be
+// scheduled before any higher priority task
+#define PECO_TASK_STARVATION_LIMIT_MS   20
+#endif
+
+#ifndef PECO_BUSY_POLL_GROW_START_US
+// The first spin budget when busy-polling starts to grow from zero
+#define PECO_BUSY_POLL_GROW_START_US    10
+#endif
+
 /**
  * @brief Task Status
 */
@@ -104,6 +131,54 @@ typedef enum {
   kTaskStatusStopped,
 } TaskStatus;
 
+/**
+ * @brief Task Priority Class
+*/
+typedef enum {
+  /**
+   * @brief Latency-critical task, always be scheduled first
+  */
+  kTaskPriorityHigh   = 0,
+  /**
+   * @brief Default priority of all tasks
+  */
+  kTaskPriorityNormal = 1,
+  /**
+   * @brief Bulk or background task
+  */
+  kTaskPriorityLow    = 2
+} TaskPriority;
+
+/**
+ * @brief How a loop task repeats its worker
+*/
+typedef enum {
+  /**
+   * @brief Rebuild the stack context before each fire
+  */
+  kRepeatModeReset      = 0,
+  /**
+   * @brief Run the worker in one long-lived coroutine which parks
+   * until the next fire, no context rebuild between fires
+  */
+  kRepeatModePersistent = 1
+} RepeatMode;
+
+/**
+ * @brief Clock Mode of a loop
+*/
+typedef enum {
+  /**
+   * @brief Time goes with the steady clock
+  */
+  kClockModeReal      = 0,
+  /**
+   * @brief Time only moves when the loop is idle, and jumps straight
+   * to the next timed task or timer
+  */
+  kClockModeVirtual   = 1
+} ClockMode;
+
 /**
  * @brief Task Waiting Signal
 */
@@ -133,7 +208,12 @@ typedef enum {
   /**
    * @brief The file descriptor is ready for writing
   */
-  kEventTypeWrite     = 0x02
+  kEventTypeWrite     = 0x02,
+  /**
+   * @brief The file descriptor has messages in its error queue, like the
+   * completions of zero-copy sends, only on Linux
+  */
+  kEventTypeError     = 0x04
 } EventType;
 
 enum {
@@ -145,7 +225,12 @@ enum {
   /**
    * @brief Task name's max length
   */
-  kTaskNameLength     = 64
+  kTaskNameLength     = 64,
+
+  /**
+   * @brief Count of task priority classes
+  */
+  kTaskPriorityCount  = 3
 };
 
 } // namespace peco
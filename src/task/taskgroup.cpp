@@ -0,0 +1,169 @@
+/*
+    taskgroup.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/taskgroup.h"
+
+namespace peco {
+
+/**
+ * @brief Create a task group with given policy
+*/
+std::shared_ptr<task_group> task_group::create(GroupPolicy policy) {
+  return std::shared_ptr<task_group>(new task_group(policy));
+}
+
+/**
+ * @brief Not allow to create group object directly
+*/
+task_group::task_group(GroupPolicy policy) : policy_(policy) { }
+
+/**
+ * @brief Start a child task in this group, if the group has already been
+ * cancelled, will return an invalidate task
+*/
+task task_group::run(group_worker_t worker, const char* name) {
+  if (cancelled_) return task(kInvalidateTaskId);
+  auto self = this->shared_from_this();
+  auto child = loop::shared()->run([self, worker]() {
+    bool succeed = worker();
+    self->on_child_exit_(task::this_task().task_id(), succeed);
+  }, name);
+  children_.push_back(child.task_id());
+  return child;
+}
+
+/**
+ * @brief Park current task until all children finish.
+ * If current task is cancelled when joining, the whole group will be cancelled.
+ * @return false if the group failed according to its policy
+*/
+bool task_group::join() {
+  while (children_.size() > 0) {
+    if (join_signal_.wait()) continue;
+    if (task::this_task().is_cancelled()) {
+      // Spread the cancellation to all children, and cannot be holded anymore
+      this->cancel();
+      return false;
+    }
+  }
+  return this->succeed_();
+}
+
+/**
+ * @brief Park current task until all children finish or timedout
+ * @return false if timedout or the group failed according to its policy
+*/
+bool task_group::join_until(duration_t timedout) {
+  auto expect_end = TASK_TIME_NOW() + timedout;
+  while (children_.size() > 0) {
+    auto now = TASK_TIME_NOW();
+    if (now >= expect_end) return false;
+    if (join_signal_.wait_until(expect_end - now)) continue;
+    if (task::this_task().is_cancelled()) {
+      this->cancel();
+      return false;
+    }
+  }
+  return this->succeed_();
+}
+
+/**
+ * @brief Cancel all children in one pass
+*/
+void task_group::cancel() {
+  cancelled_ = true;
+  for (auto tid : children_) {
+    task(tid).cancel();
+  }
+}
+
+/**
+ * @brief If the group has been cancelled
+*/
+bool task_group::is_cancelled() const {
+  return cancelled_;
+}
+
+/**
+ * @brief Get the running children count
+*/
+size_t task_group::size() const {
+  return children_.size();
+}
+
+/**
+ * @brief Get the first child which reported an error
+*/
+task_id_t task_group::first_error() const {
+  return first_error_;
+}
+
+/**
+ * @brief Get the first child which finished successfully
+*/
+task_id_t task_group::first_result() const {
+  return first_result_;
+}
+
+/**
+ * @brief Invoked by the child task right before it exits
+*/
+void task_group::on_child_exit_(task_id_t tid, bool succeed) {
+  auto it = std::find(children_.begin(), children_.end(), tid);
+  if (it != children_.end()) {
+    children_.erase(it);
+  }
+  if (succeed && first_result_ == kInvalidateTaskId) {
+    first_result_ = tid;
+    if (policy_ == kGroupPolicyFirstResult) this->cancel();
+  }
+  if (!succeed && first_error_ == kInvalidateTaskId) {
+    first_error_ = tid;
+    if (policy_ == kGroupPolicyFirstError) this->cancel();
+  }
+  if (children_.size() == 0) {
+    join_signal_.trigger_all();
+  }
+}
+
+/**
+ * @brief Tell if the group succeed according to its policy
+*/
+bool task_group::succeed_() const {
+  if (policy_ == kGroupPolicyFirstResult) {
+    return first_result_ != kInvalidateTaskId;
+  }
+  return first_error_ == kInvalidateTaskId;
+}
+
+} // namespace peco
+
+// Push Chen
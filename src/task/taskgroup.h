@@ -0,0 +1,156 @@
+/*
+    taskgroup.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TASKGROUP_H__
+#define PECO_TASKGROUP_H__
+
+#include "task/task.h"
+#include "task/loop.h"
+#include "task/signal.h"
+
+#include <list>
+
+namespace peco {
+
+/**
+ * @brief Worker of a child task in the group, return false to report an error
+*/
+typedef std::function< bool(void) >               group_worker_t;
+
+/**
+ * @brief How a group reacts when a child task finishes
+*/
+typedef enum {
+  /**
+   * @brief Just wait for all children to finish
+  */
+  kGroupPolicyJoinAll,
+  /**
+   * @brief Cancel the whole group when the first child reports an error
+  */
+  kGroupPolicyFirstError,
+  /**
+   * @brief Cancel the whole group when the first child finishes successfully
+  */
+  kGroupPolicyFirstResult
+} GroupPolicy;
+
+/**
+ * @brief A group tracks the child tasks started by it, only can be used in
+ * the thread which create it. Each child keeps the group alive until it
+ * exits, so dropping the group does not stop the children, join() or
+ * cancel() it to bound their lifetime. Cancelling the parent reaches the
+ * children only while the parent is parked in join() or join_until().
+*/
+class task_group : public std::enable_shared_from_this<task_group> {
+public:
+  /**
+   * @brief Create a task group with given policy
+  */
+  static std::shared_ptr<task_group> create(GroupPolicy policy = kGroupPolicyJoinAll);
+
+public:
+  /**
+   * @brief Start a child task in this group, if the group has already been
+   * cancelled, will return an invalidate task
+  */
+  task run(group_worker_t worker, const char* name = nullptr);
+
+  /**
+   * @brief Park current task until all children finish.
+   * If current task is cancelled when joining, the whole group will be cancelled.
+   * @return false if the group failed according to its policy
+  */
+  bool join();
+
+  /**
+   * @brief Park current task until all children finish or timedout
+   * @return false if timedout or the group failed according to its policy
+  */
+  bool join_until(duration_t timedout);
+
+  /**
+   * @brief Cancel all children in one pass
+  */
+  void cancel();
+
+  /**
+   * @brief If the group has been cancelled
+  */
+  bool is_cancelled() const;
+
+  /**
+   * @brief Get the running children count
+  */
+  size_t size() const;
+
+  /**
+   * @brief Get the first child which reported an error
+  */
+  task_id_t first_error() const;
+
+  /**
+   * @brief Get the first child which finished successfully
+  */
+  task_id_t first_result() const;
+
+protected:
+  /**
+   * @brief Not allow to create group object directly
+  */
+  task_group(GroupPolicy policy);
+
+  /**
+   * @brief Invoked by the child task right before it exits
+  */
+  void on_child_exit_(task_id_t tid, bool succeed);
+
+  /**
+   * @brief Tell if the group succeed according to its policy
+  */
+  bool succeed_() const;
+
+protected:
+  GroupPolicy             policy_;
+  std::list<task_id_t>    children_;
+  signal                  join_signal_;
+  bool                    cancelled_ = false;
+  task_id_t               first_error_ = kInvalidateTaskId;
+  task_id_t               first_result_ = kInvalidateTaskId;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
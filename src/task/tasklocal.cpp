@@ -0,0 +1,69 @@
+/*
+    tasklocal.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/tasklocal.h"
+#include "task/impl/basictask.hxx"
+#include "basic/logs.h"
+
+namespace peco {
+
+/**
+ * @brief Register a slot for the value of <size>
+*/
+task_local_base::task_local_base(size_t size, size_t align, destructor_t dtor) {
+  slot_ = basic_task::alloc_local_slot(size, align, dtor);
+  if (slot_ == kMaxTaskLocalCount) {
+    log::error << "too many task local keys, max count is " << (size_t)kMaxTaskLocalCount << std::endl;
+  }
+}
+
+/**
+ * @brief Get current task's value, construct it with <ctor> if needed.
+ * Return nullptr if not in any task, or <ctor> is null and no value
+*/
+void* task_local_base::value_(constructor_t ctor) const {
+  auto& rt = basic_task::running_task();
+  if (rt == nullptr) return nullptr;
+  return rt->local_value(slot_, ctor);
+}
+
+/**
+ * @brief Destroy current task's value
+*/
+void task_local_base::reset_() {
+  auto& rt = basic_task::running_task();
+  if (rt == nullptr) return;
+  rt->reset_local(slot_);
+}
+
+} // namespace peco
+
+// Push Chen
@@ -0,0 +1,130 @@
+/*
+    tasklocal.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TASKLOCAL_H__
+#define PECO_TASKLOCAL_H__
+
+#include "pecostd.h"
+#include "task/taskdef.h"
+
+namespace peco {
+
+/**
+ * @brief Untyped part of the task local storage key
+*/
+class task_local_base {
+public:
+  typedef void (*constructor_t)(void*);
+  typedef void (*destructor_t)(void*);
+
+  /**
+   * @brief Key is not copyable
+  */
+  task_local_base(const task_local_base&) = delete;
+  task_local_base& operator = (const task_local_base&) = delete;
+
+protected:
+  /**
+   * @brief Register a slot for the value of <size>
+  */
+  task_local_base(size_t size, size_t align, destructor_t dtor);
+
+  /**
+   * @brief Get current task's value, construct it with <ctor> if needed.
+   * Return nullptr if not in any task, or <ctor> is null and no value
+  */
+  void* value_(constructor_t ctor) const;
+
+  /**
+   * @brief Destroy current task's value
+  */
+  void reset_();
+
+protected:
+  size_t slot_;
+};
+
+/**
+ * @brief Typed task local storage key. The value is stored in the reserved
+ * region of each task's stack and destroyed when the task exits.
+ * The key should have a static lifetime, usually a global variable.
+*/
+template <typename T>
+class task_local : public task_local_base {
+public:
+  task_local() : task_local_base(sizeof(T), alignof(T), &task_local<T>::destroy_) { }
+
+  /**
+   * @brief Get current task's value, default construct it at the first access.
+   * Return nullptr if not in any task
+  */
+  T* get() const {
+    return reinterpret_cast<T *>(this->value_(&task_local<T>::construct_));
+  }
+
+  /**
+   * @brief Set current task's value
+  */
+  void set(T value) {
+    T* p = this->get();
+    if (p != nullptr) *p = std::move(value);
+  }
+
+  /**
+   * @brief Tell if current task has the value
+  */
+  bool has() const {
+    return this->value_(nullptr) != nullptr;
+  }
+
+  /**
+   * @brief Destroy current task's value
+  */
+  void reset() {
+    this->reset_();
+  }
+
+protected:
+  static void construct_(void* p) {
+    new (p) T();
+  }
+  static void destroy_(void* p) {
+    reinterpret_cast<T *>(p)->~T();
+  }
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
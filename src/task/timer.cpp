@@ -0,0 +1,88 @@
+/*
+    timer.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "task/timer.h"
+#include "task/impl/loopimpl.hxx"
+
+namespace peco {
+
+/**
+ * @brief Create a timer handler by its id
+*/
+timer::timer(timer_id_t tid) : tid_(tid) {}
+
+/**
+ * @brief Copy & Move C'stor
+*/
+timer::timer(const timer& other) : tid_(other.tid_) {}
+timer::timer(timer&& other) : tid_(other.tid_) {}
+/**
+ * @brief Operator = & Operator move
+*/
+timer& timer::operator = (const timer& other) {
+  if (this != &other) {
+    tid_ = other.tid_;
+  }
+  return *this;
+}
+timer& timer::operator = (timer&& other) {
+  if (this != &other) {
+    tid_ = other.tid_;
+  }
+  return *this;
+}
+
+/**
+ * @brief Check if the timer is still waiting to be fired
+*/
+bool timer::is_alive() const {
+  if (tid_ == kInvalidateTimerId) return false;
+  return loopimpl::shared().has_timer(tid_);
+}
+
+/**
+ * @brief Get the timer id
+*/
+timer_id_t timer::timer_id() const {
+  return tid_;
+}
+
+/**
+ * @brief Cancel the timer, the worker will never be invoked again
+*/
+void timer::cancel() {
+  if (tid_ == kInvalidateTimerId) return;
+  loopimpl::shared().cancel_timer(tid_);
+}
+
+} // namespace peco
+
+// Push Chen
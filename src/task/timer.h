@@ -0,0 +1,94 @@
+/*
+    timer.h
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PECO_TIMER_H__
+#define PECO_TIMER_H__
+
+#include "pecostd.h"
+#include "task/taskdef.h"
+
+namespace peco {
+
+/**
+ * @brief A stackless timer handler, only can be used in the thread which create it.
+ * The timer's worker runs on the loop's main context, so it must not
+ * hold, sleep or wait for any fd event.
+*/
+class timer {
+public:
+  /**
+   * @brief Create a timer handler by its id
+  */
+  timer(timer_id_t tid = kInvalidateTimerId);
+
+  /**
+   * @brief Copy & Move C'stor
+  */
+  timer(const timer& other);
+  timer(timer&& other);
+  /**
+   * @brief Operator = & Operator move
+  */
+  timer& operator = (const timer& other);
+  timer& operator = (timer&& other);
+
+  /**
+   * @brief Default D'stor, will not cancel the timer
+  */
+  ~timer() = default;
+
+public:
+  /**
+   * @brief Check if the timer is still waiting to be fired
+  */
+  bool is_alive() const;
+
+  /**
+   * @brief Get the timer id
+  */
+  timer_id_t timer_id() const;
+
+  /**
+   * @brief Cancel the timer, the worker will never be invoked again
+  */
+  void cancel();
+
+protected:
+  timer_id_t tid_;
+};
+
+} // namespace peco
+
+#endif
+
+// Push Chen
@@ -0,0 +1,97 @@
+/*
+    bench_busy_poll.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Measure the round-trip time of a ping-pong between a blocking peer
+// thread and a task on the loop, with and without busy-polling.
+
+const int kPingCount = 20000;
+const auto kThinkTime = PECO_TIME_US(20);
+
+void run_case(const char* title, peco::duration_t max_budget) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return;
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+  std::vector<int64_t> rtt;
+  rtt.reserve(kPingCount);
+  std::thread peer([&]() {
+    char c = 'p';
+    for (int i = 0; i < kPingCount; ++i) {
+      auto think_end = TASK_TIME_NOW() + kThinkTime;
+      while (TASK_TIME_NOW() < think_end);
+      auto begin = TASK_TIME_NOW();
+      if (write(fds[1], &c, 1) != 1) break;
+      if (read(fds[1], &c, 1) != 1) break;
+      rtt.push_back((TASK_TIME_NOW() - begin).count());
+    }
+    close(fds[1]);
+  });
+
+  peco::loop::shared()->set_busy_poll(max_budget);
+  peco::loop::shared()->run([&]() {
+    char c;
+    while (true) {
+      peco::task::this_task().wait_fd_for_event(fds[0], peco::kEventTypeRead, PECO_TIME_S(5));
+      if (peco::task::this_task().signal() != peco::kWaitingSignalReceived) break;
+      auto ret = read(fds[0], &c, 1);
+      if (ret <= 0) break;
+      peco::ignore_result(write(fds[0], &c, 1));
+    }
+  });
+  peco::ignore_result(peco::loop::shared()->main());
+  peer.join();
+  close(fds[0]);
+
+  if (rtt.size() == 0) return;
+  std::sort(rtt.begin(), rtt.end());
+  auto p50 = rtt[rtt.size() / 2];
+  auto p99 = rtt[rtt.size() * 99 / 100];
+  peco::log::info << title << ": rtt p50 = " << p50 / 1000 << "us, p99 = "
+    << p99 / 1000 << "us, busy-poll time = "
+    << std::chrono::duration_cast<std::chrono::milliseconds>(
+      peco::loop::shared()->busy_poll_time()).count()
+    << "ms" << std::endl;
+}
+
+int main() {
+  run_case("no busy-poll", peco::duration_t::zero());
+  run_case("busy-poll 200us", PECO_TIME_US(200));
+  return 0;
+}
@@ -0,0 +1,129 @@
+/*
+    bench_net_write.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+#include <vector>
+
+// Bulk responses through a loopback tcp connection, count the send
+// syscalls of each write style.
+
+size_t g_send_calls = 0;
+
+extern "C" ssize_t send(int fd, const void* buf, size_t len, int flags) {
+  typedef ssize_t (*send_t)(int, const void*, size_t, int);
+  static send_t real_send = (send_t)dlsym(RTLD_NEXT, "send");
+  ++g_send_calls;
+  return real_send(fd, buf, len, flags);
+}
+extern "C" ssize_t sendmsg(int fd, const struct msghdr* msg, int flags) {
+  typedef ssize_t (*sendmsg_t)(int, const struct msghdr*, int);
+  static sendmsg_t real_sendmsg = (sendmsg_t)dlsym(RTLD_NEXT, "sendmsg");
+  ++g_send_calls;
+  return real_sendmsg(fd, msg, flags);
+}
+
+const size_t kHeaderSize = 256;
+const size_t kBodySize = 1024 * 1024;
+const int kRoundCount = 200;
+
+enum WriteStyle { kChunked, kConcat, kVectored };
+
+void run_case(const char* title, WriteStyle style, uint16_t port) {
+  std::string header(kHeaderSize, 'h');
+  std::string body(kBodySize, 'b');
+  const size_t total = (kHeaderSize + kBodySize) * kRoundCount;
+  size_t send_calls = 0;
+  peco::duration_t cost = peco::duration_t::zero();
+  std::string addr = "127.0.0.1:" + std::to_string(port);
+
+  peco::loop::shared()->run([&]() {
+    auto tl = peco::tcp_listener::create();
+    if (!tl->bind(addr)) {
+      peco::loop::shared()->exit();
+      return;
+    }
+    tl->listen([&](std::shared_ptr<peco::tcp_connector> incoming) {
+      auto begin = TASK_TIME_NOW();
+      auto calls = g_send_calls;
+      bool ok = true;
+      for (int r = 0; r < kRoundCount && ok; ++r) {
+        if (style == kChunked) {
+          // The old way, concatenate and send in 4KB pieces
+          std::string resp = header + body;
+          for (size_t sent = 0; sent < resp.size() && ok; sent += 4096) {
+            ok = incoming->write(resp.data() + sent, std::min((size_t)4096, resp.size() - sent));
+          }
+        } else if (style == kConcat) {
+          ok = incoming->write(header + body);
+        } else {
+          ok = incoming->write({{header.data(), header.size()}, {body.data(), body.size()}});
+        }
+      }
+      if (!ok) peco::log::error << title << ": failed to write the responses" << std::endl;
+      send_calls = g_send_calls - calls;
+      cost = TASK_TIME_NOW() - begin;
+      peco::task::this_task().sleep(PECO_TIME_MS(100));
+      peco::loop::shared()->exit();
+    });
+  });
+
+  peco::loop::shared()->run_delay([&]() {
+    auto c = peco::tcp_connector::create();
+    if (!c->connect(addr)) {
+      peco::log::error << title << ": failed to connect to " << addr << std::endl;
+      peco::loop::shared()->exit();
+      return;
+    }
+    std::vector<char> buffer(256 * 1024);
+    size_t received = 0, n = 0;
+    while (received < total) {
+      if (c->read_into(buffer.data(), buffer.size(), n) != peco::kNetOpStatusOK) break;
+      received += n;
+    }
+    if (received != total) {
+      peco::log::error << title << ": received " << received << " of " << total << std::endl;
+    }
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  peco::log::info << title << ": " << send_calls << " send calls, "
+    << (send_calls * 1000 / kRoundCount) / 1000.0 << " per response, "
+    << (int64_t)((double)total / (1024 * 1024) / (cost.count() / 1e9)) << " MB/s" << std::endl;
+}
+
+int main() {
+  run_case("4KB chunks", kChunked, 12391);
+  run_case("single write", kConcat, 12392);
+  run_case("vectored header+body", kVectored, 12393);
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*
+    bench_task_priority.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <vector>
+#include <algorithm>
+
+// Measure how late a periodic latency-critical task wakes up when
+// the loop is flooded by bulk tasks which burn CPU and yield.
+
+const int kFloodTaskCount = 100;
+const int kProbeCount = 100;
+const auto kSliceTime = PECO_TIME_NS(50000);    // 50us per bulk slice
+const auto kProbeInterval = PECO_TIME_MS(2);
+
+void burn(peco::duration_t d) {
+  auto end_time = TASK_TIME_NOW() + d;
+  while (TASK_TIME_NOW() < end_time);
+}
+
+void run_case(const char* title, peco::TaskPriority flood_priority, peco::TaskPriority probe_priority) {
+  bool probing = true;
+  std::vector<int64_t> lateness;
+  lateness.reserve(kProbeCount);
+  for (int i = 0; i < kFloodTaskCount; ++i) {
+    auto t = peco::loop::shared()->run([&probing]() {
+      while (probing) {
+        burn(kSliceTime);
+        peco::task::this_task().yield();
+      }
+    });
+    t.set_priority(flood_priority);
+  }
+  auto probe = peco::loop::shared()->run([&]() {
+    for (int i = 0; i < kProbeCount; ++i) {
+      auto expect_time = TASK_TIME_NOW() + kProbeInterval;
+      peco::task::this_task().sleep(kProbeInterval);
+      lateness.push_back((TASK_TIME_NOW() - expect_time).count());
+    }
+    probing = false;
+  });
+  probe.set_priority(probe_priority);
+  peco::ignore_result(peco::loop::shared()->main());
+
+  std::sort(lateness.begin(), lateness.end());
+  auto p50 = lateness[lateness.size() / 2];
+  auto p99 = lateness[lateness.size() * 99 / 100];
+  peco::log::info << title << ": probe lateness p50 = " << p50 / 1000 << "us, p99 = "
+    << p99 / 1000 << "us, max = " << lateness.back() / 1000 << "us" << std::endl;
+}
+
+int main() {
+  run_case("same priority", peco::kTaskPriorityNormal, peco::kTaskPriorityNormal);
+  run_case("high over low", peco::kTaskPriorityLow, peco::kTaskPriorityHigh);
+  return 0;
+}
@@ -0,0 +1,84 @@
+/*
+    bench_task_spawn.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <vector>
+
+// Measure the spawn throughput of a scatter-gather fan-out, spawn one
+// task per shard and wait all of them to finish, round after round.
+
+const int kShardCount = 64;
+const int kRoundCount = 2000;
+
+void run_case(const char* title, bool batch) {
+  std::vector<int> shards;
+  for (int i = 0; i < kShardCount; ++i) shards.push_back(i);
+  peco::duration_t spawn_time = peco::duration_t::zero();
+  auto begin = TASK_TIME_NOW();
+
+  peco::loop::shared()->run([&]() {
+    auto parent = peco::task::this_task();
+    int pending = 0;
+    int64_t sum = 0;
+    auto on_shard = [&](int shard) {
+      sum += shard;
+      if (--pending == 0) parent.wakeup();
+    };
+    for (int r = 0; r < kRoundCount; ++r) {
+      pending = kShardCount;
+      auto spawn_begin = TASK_TIME_NOW();
+      if (batch) {
+        peco::loop::shared()->run_batch(shards.begin(), shards.end(), on_shard);
+      } else {
+        for (auto shard : shards) {
+          peco::loop::shared()->run([on_shard, shard]() { on_shard(shard); });
+        }
+      }
+      spawn_time += (TASK_TIME_NOW() - spawn_begin);
+      while (pending > 0) parent.holding();
+    }
+    assert(sum == (int64_t)kRoundCount * kShardCount * (kShardCount - 1) / 2);
+  });
+  peco::ignore_result(peco::loop::shared()->main());
+
+  auto total = TASK_TIME_NOW() - begin;
+  double task_count = (double)kRoundCount * kShardCount;
+  peco::log::info << title << ": spawn " << (int64_t)(task_count / (spawn_time.count() / 1e9))
+    << " tasks/s, fan-out round trip "
+    << (int64_t)(task_count / (total.count() / 1e9)) << " tasks/s" << std::endl;
+}
+
+int main() {
+  run_case("run", false);
+  run_case("run_batch", true);
+  return 0;
+}
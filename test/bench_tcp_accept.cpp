@@ -0,0 +1,147 @@
+/*
+    bench_tcp_accept.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <vector>
+
+// Accept rounds of loopback connections, the clients are raw nonblocking
+// sockets, so all the counted option syscalls come from the accept side.
+
+size_t g_option_calls = 0;
+
+extern "C" int setsockopt(int fd, int level, int name, const void* value, socklen_t len) {
+  typedef int (*setsockopt_t)(int, int, int, const void*, socklen_t);
+  static setsockopt_t real_setsockopt = (setsockopt_t)dlsym(RTLD_NEXT, "setsockopt");
+  ++g_option_calls;
+  return real_setsockopt(fd, level, name, value, len);
+}
+extern "C" int fcntl(int fd, int cmd, ...) {
+  typedef int (*fcntl_t)(int, int, ...);
+  static fcntl_t real_fcntl = (fcntl_t)dlsym(RTLD_NEXT, "fcntl");
+  va_list ap;
+  va_start(ap, cmd);
+  long arg = va_arg(ap, long);
+  va_end(ap);
+  ++g_option_calls;
+  return real_fcntl(fd, cmd, arg);
+}
+extern "C" int getpeername(int fd, struct sockaddr* addr, socklen_t* len) {
+  typedef int (*getpeername_t)(int, struct sockaddr*, socklen_t*);
+  static getpeername_t real_getpeername = (getpeername_t)dlsym(RTLD_NEXT, "getpeername");
+  ++g_option_calls;
+  return real_getpeername(fd, addr, len);
+}
+
+const int kRoundCount = 50;
+const int kRoundConnections = 200;
+
+void run_case(const char* title, bool legacy, uint16_t port) {
+  const int total = kRoundCount * kRoundConnections;
+  int accepted = 0;
+  size_t option_calls = 0;
+  peco::duration_t cost = peco::duration_t::zero();
+  peco::peer_t addr("127.0.0.1:" + std::to_string(port));
+
+  auto tl = peco::tcp_listener::create();
+  if (!tl->bind(addr)) return;
+  if (legacy) {
+    // The old way, blocking-style accept, then set every option again
+    if (::listen(tl->native_fd(), CO_MAX_SO_EVENTS) != 0) {
+      peco::log::error << title << ": failed to listen, " << ::strerror(errno) << std::endl;
+      return;
+    }
+    peco::loop::shared()->run([&]() {
+      while (true) {
+        peco::task::this_task().wait_fd_for_event(tl->native_fd(), peco::kEventTypeRead, PECO_TIME_S(10));
+        if (peco::task::this_task().signal() != peco::kWaitingSignalReceived) return;
+        while (true) {
+          struct sockaddr in_addr;
+          socklen_t in_len = sizeof(in_addr);
+          peco::SOCKET_T in_fd = ::accept(tl->native_fd(), &in_addr, &in_len);
+          if (in_fd == -1) break;
+          auto peer = peco::net_utils::socket_peerinfo(in_fd);
+          peco::loop::shared()->run([&, in_fd, peer]() {
+            auto incoming = peco::tcp_connector::create(in_fd);
+            peco::ignore_result(peer);
+            ++accepted;
+          });
+        }
+      }
+    });
+  } else {
+    if (!tl->listen([&](std::shared_ptr<peco::tcp_connector> incoming) {
+      peco::ignore_result(incoming);
+      ++accepted;
+    })) return;
+  }
+
+  peco::loop::shared()->run_delay([&]() {
+    struct sockaddr_in dest = addr;
+    auto calls = g_option_calls;
+    auto begin = TASK_TIME_NOW();
+    std::vector<int> fds;
+    for (int r = 0; r < kRoundCount; ++r) {
+      for (int i = 0; i < kRoundConnections; ++i) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd == -1) continue;
+        if (::connect(fd, (struct sockaddr *)&dest, sizeof(dest)) != 0 && errno != EINPROGRESS) {
+          peco::log::error << title << ": failed to connect, " << ::strerror(errno) << std::endl;
+        }
+        fds.push_back(fd);
+      }
+      int expect = (r + 1) * kRoundConnections;
+      while (accepted < expect && TASK_TIME_NOW() - begin < PECO_TIME_S(30)) {
+        peco::task::this_task().sleep(PECO_TIME_US(10));
+      }
+      for (auto fd : fds) ::close(fd);
+      fds.clear();
+    }
+    cost = TASK_TIME_NOW() - begin;
+    option_calls = g_option_calls - calls;
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  peco::log::info << title << ": " << accepted << "/" << total << " accepted, "
+    << (int64_t)((double)accepted / (cost.count() / 1e9)) << " accepts/s, "
+    << (double)option_calls / accepted << " option syscalls per connection" << std::endl;
+}
+
+int main() {
+  run_case("accept + per-socket options", true, 12391);
+  run_case("accept4 + inherited options", false, 12392);
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+    bench_udp_gso.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+
+// Bursts of datagrams through loopback udp, with and without segmentation
+// offload, count the sendto syscalls and the datagrams per second.
+
+size_t g_send_calls = 0;
+
+extern "C" ssize_t sendto(int fd, const void* buf, size_t len, int flags,
+  const struct sockaddr* addr, socklen_t addr_len) {
+  typedef ssize_t (*sendto_t)(int, const void*, size_t, int, const struct sockaddr*, socklen_t);
+  static sendto_t real_sendto = (sendto_t)dlsym(RTLD_NEXT, "sendto");
+  ++g_send_calls;
+  return real_sendto(fd, buf, len, flags, addr, addr_len);
+}
+
+const size_t kSegmentSize = PECO_NET_UDP_SEGMENT_SIZE;
+const size_t kBurstSegments = 40;
+const int kRoundCount = 5000;
+
+void run_case(const char* title, bool gso, bool gro, uint16_t port) {
+  std::string burst(kSegmentSize * kBurstSegments, 'd');
+  const size_t total = kBurstSegments * kRoundCount;
+  size_t received = 0, packets = 0, send_calls = 0;
+  peco::duration_t cost = peco::duration_t::zero();
+  std::string addr = "127.0.0.1:" + std::to_string(port);
+
+  auto receiver = peco::udp_listener::create();
+  if (!receiver->bind(addr)) return;
+  peco::net_utils::buffersize(receiver->native_fd(), 4 * 1024 * 1024, 0);
+  if (gro && !receiver->set_gro(true)) {
+    peco::log::error << title << ": GRO is not supported" << std::endl;
+    return;
+  }
+  if (!receiver->listen([&](std::shared_ptr<peco::udp_packet> pkt) {
+    size_t seg = pkt->segment_size();
+    received += (seg == 0 ? 1 : (pkt->data().size() + seg - 1) / seg);
+    packets += 1;
+  })) return;
+
+  peco::loop::shared()->run_delay([&]() {
+    auto sender = peco::udp_listener::create();
+    if (!sender->bind("127.0.0.1:" + std::to_string(port + 10)) ||
+      (gso && !sender->set_gso(kSegmentSize))) {
+      peco::log::error << title << ": failed to prepare the sender" << std::endl;
+      peco::loop::shared()->exit();
+      return;
+    }
+    peco::peer_t dest(addr);
+    auto begin = TASK_TIME_NOW();
+    auto calls = g_send_calls;
+    for (int r = 0; r < kRoundCount; ++r) {
+      if (!sender->writeto(dest, burst)) break;
+      // Let the receiver drain the socket, a yield does not poll the fds
+      while (received < kBurstSegments * (r + 1) && TASK_TIME_NOW() - begin < PECO_TIME_S(10)) {
+        peco::task::this_task().sleep(PECO_TIME_US(10));
+      }
+    }
+    send_calls = g_send_calls - calls;
+    while (received < total && TASK_TIME_NOW() - begin < PECO_TIME_S(10)) {
+      peco::task::this_task().sleep(PECO_TIME_MS(1));
+    }
+    cost = TASK_TIME_NOW() - begin;
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  peco::log::info << title << ": " << send_calls << " sendto calls, "
+    << received << "/" << total << " datagrams in " << packets << " reads, "
+    << (int64_t)((double)received / (cost.count() / 1e9)) << " datagrams/s" << std::endl;
+}
+
+int main() {
+  run_case("no offload", false, false, 12391);
+  run_case("gso", true, false, 12392);
+  run_case("gso+gro", true, true, 12393);
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+    net_buffered_writer.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+
+// Count the send syscalls
+size_t g_send_calls = 0;
+
+extern "C" ssize_t send(int fd, const void* buf, size_t len, int flags) {
+  typedef ssize_t (*send_t)(int, const void*, size_t, int);
+  static send_t real_send = (send_t)dlsym(RTLD_NEXT, "send");
+  ++g_send_calls;
+  return real_send(fd, buf, len, flags);
+}
+extern "C" ssize_t sendmsg(int fd, const struct msghdr* msg, int flags) {
+  typedef ssize_t (*sendmsg_t)(int, const struct msghdr*, int);
+  static sendmsg_t real_sendmsg = (sendmsg_t)dlsym(RTLD_NEXT, "sendmsg");
+  ++g_send_calls;
+  return real_sendmsg(fd, msg, flags);
+}
+
+const size_t kMessageCount = 100;
+std::string received;
+size_t slow_received = 0;
+bool done = false;
+
+int main() {
+  // Idle hooks run once after all ready tasks
+  std::string order;
+  peco::loop::shared()->run([&]() {
+    peco::loop::shared()->call_before_idle([&]() { order += "h"; });
+    order += "a";
+  });
+  peco::loop::shared()->run([&]() {
+    order += "b";
+  });
+
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12397");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      while (true) {
+        auto r = incoming->read(PECO_TIME_MS(100));
+        if (r.status != peco::kNetOpStatusOK) break;
+        received += r.data;
+      }
+    });
+    // A slow peer which starts reading late
+    auto slow = peco::tcp_listener::create();
+    bound = slow->bind("127.0.0.1:12396");
+    assert(bound);
+    slow->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      peco::task::this_task().sleep(PECO_TIME_MS(50));
+      while (true) {
+        auto r = incoming->read(PECO_TIME_MS(100));
+        if (r.status != peco::kNetOpStatusOK) break;
+        slow_received += r.data.size();
+      }
+    });
+  });
+
+  peco::loop::shared()->run_delay([&]() {
+    assert(order == "abh");
+    auto c = peco::tcp_connector::create();
+    bool connected = c->connect("127.0.0.1:12397");
+    assert(connected);
+    peco::ignore_result(connected);
+    auto w = peco::buffered_writer::create(c, 1000);
+
+    // Small messages in one pass go out by one syscall
+    auto calls = g_send_calls;
+    bool ok = true;
+    for (size_t i = 0; i < kMessageCount; ++i) {
+      ok = w->write("msg;") && ok;
+    }
+    assert(ok);
+    assert(g_send_calls == calls);
+    assert(w->pending() == kMessageCount * 4);
+    // Flushed when the loop goes idle
+    peco::task::this_task().sleep(PECO_TIME_MS(1));
+    assert(w->pending() == 0);
+    assert(g_send_calls == calls + 1);
+
+    // Reaching the threshold flushes at once
+    calls = g_send_calls;
+    ok = w->write(std::string(1200, 'x'));
+    assert(ok);
+    assert(w->pending() == 0);
+    assert(g_send_calls == calls + 1);
+    peco::ignore_result(calls);
+
+    // Explicit flush
+    ok = w->write("end;") && w->flush();
+    assert(ok);
+    assert(w->pending() == 0);
+
+    // A second flush waits for the running one instead of returning at once
+    auto sc = peco::tcp_connector::create();
+    connected = sc->connect("127.0.0.1:12396");
+    assert(connected);
+    auto sw = peco::buffered_writer::create(sc, 1000);
+    const size_t kLargeSize = 16 * 1024 * 1024;
+    bool first_done = false;
+    peco::loop::shared()->run([&]() {
+      bool sent = sw->write(std::string(kLargeSize, 'y'));
+      assert(sent);
+      peco::ignore_result(sent);
+      first_done = true;
+    });
+    peco::task::this_task().yield();
+    assert(!first_done);
+    ok = sw->write("tail;") && sw->flush(PECO_TIME_S(5));
+    assert(ok);
+    assert(first_done);
+    assert(sw->pending() == 0);
+
+    peco::task::this_task().sleep(PECO_TIME_MS(20));
+    std::string expected;
+    for (size_t i = 0; i < kMessageCount; ++i) expected += "msg;";
+    expected += std::string(1200, 'x') + "end;";
+    assert(received == expected);
+    assert(slow_received == kLargeSize + 5);
+    peco::ignore_result(ok);
+    done = true;
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(done);
+  return 0;
+}
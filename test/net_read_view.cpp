@@ -0,0 +1,176 @@
+/*
+    net_read_view.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <new>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Count all heap allocations of the process
+size_t g_alloc_count = 0;
+
+void* operator new(size_t size) {
+  ++g_alloc_count;
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept {
+  free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+const size_t kPacketSize = 1000;
+const size_t kPacketCount = 200;
+bool done = false;
+
+int main() {
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12398");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      char packet[kPacketSize];
+      for (size_t i = 0; i < kPacketCount; ++i) {
+        memset(packet, 'a' + (i % 26), kPacketSize);
+        bool written = incoming->write(packet, kPacketSize);
+        assert(written);
+        peco::ignore_result(written);
+      }
+      peco::task::this_task().sleep(PECO_TIME_MS(100));
+    });
+  });
+
+  peco::loop::shared()->run_delay([]() {
+    auto c = peco::tcp_connector::create();
+    bool connected = c->connect("127.0.0.1:12398");
+    assert(connected);
+    c->set_buffer_size(1024 * 1024, 1024 * 1024);
+    // Let all data arrive
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+
+    // Warm up the pool
+    peco::net_view first;
+    {
+      auto r = c->read_view();
+      assert(r);
+      first = r.data.sub(0, 10);
+    }
+    // The sub view keeps the slab
+    size_t free_count = peco::net_view::free_count();
+    assert(first.size() == 10);
+    assert(first.str() == std::string(10, 'a'));
+    size_t total = 0;
+    {
+      auto r = c->read_view();
+      total += r.data.size();
+    }
+    assert(peco::net_view::free_count() == free_count + 1);
+    first = peco::net_view();
+    assert(peco::net_view::free_count() == free_count + 2);
+    peco::ignore_result(free_count);
+
+    // Steady reads allocate nothing
+    size_t allocs = 0;
+    size_t reads = 0;
+    while (true) {
+      size_t before = g_alloc_count;
+      auto r = c->read_view(PECO_TIME_MS(10));
+      size_t size = r.data.size();
+      const char* p = r.data.data();
+      r = peco::inet_view_incoming{peco::kNetOpStatusFailed, peco::net_view()};
+      allocs += g_alloc_count - before;
+      if (size == 0) break;
+      assert(p[0] >= 'a' && p[0] <= 'z');
+      peco::ignore_result(p);
+      total += size;
+      ++reads;
+    }
+    peco::log::debug << "reads: " << reads << ", allocations: " << allocs << std::endl;
+    assert(allocs == 0);
+
+    // Caller-provided buffer
+    auto c2 = peco::tcp_connector::create();
+    connected = c2->connect("127.0.0.1:12398");
+    assert(connected);
+    peco::ignore_result(connected);
+    char buffer[4096];
+    size_t received = 0, total2 = 0;
+    while (total2 < kPacketSize * kPacketCount) {
+      auto status = c2->read_into(buffer, sizeof(buffer), received);
+      if (status != peco::kNetOpStatusOK) break;
+      assert(received > 0);
+      total2 += received;
+    }
+    assert(total2 == kPacketSize * kPacketCount);
+    // Nothing more, timed out instead of an empty read
+    auto status = c2->read_into(buffer, sizeof(buffer), received, PECO_TIME_MS(5));
+    assert(status == peco::kNetOpStatusTimedout);
+    assert(received == 0);
+    peco::ignore_result(status);
+
+    // Two readers are woken up by one byte, the one getting nothing keeps
+    // waiting until its timeout instead of returning an empty read
+    int pair[2];
+    int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+    assert(ret == 0);
+    peco::ignore_result(ret);
+    auto c3 = peco::tcp_connector::create(pair[0]);
+    peco::net_utils::nonblocking(pair[0], true);
+    int ok_count = 0, timedout_count = 0;
+    for (int i = 0; i < 2; ++i) {
+      peco::loop::shared()->run([&]() {
+        char b[16];
+        size_t n = 0;
+        auto s = c3->read_into(b, sizeof(b), n, PECO_TIME_MS(100));
+        if (s == peco::kNetOpStatusOK && n == 1) ++ok_count;
+        if (s == peco::kNetOpStatusTimedout && n == 0) ++timedout_count;
+      });
+    }
+    peco::task::this_task().sleep(PECO_TIME_MS(10));
+    ret = (int)::write(pair[1], "x", 1);
+    peco::task::this_task().sleep(PECO_TIME_MS(200));
+    assert(ok_count == 1);
+    assert(timedout_count == 1);
+    ::close(pair[1]);
+    done = true;
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(done);
+  return 0;
+}
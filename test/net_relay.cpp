@@ -0,0 +1,127 @@
+/*
+    net_relay.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <sys/socket.h>
+
+const size_t kDataSize = 1024 * 1024;
+peco::RelayMode g_mode = peco::kRelayModeAuto;
+std::shared_ptr<peco::relay_stats> g_stats;
+// The forwarder gives the request a short deadline
+bool g_short_deadline = false;
+int done_count = 0;
+
+void run_client(peco::RelayMode mode, bool short_deadline = false) {
+  g_mode = mode;
+  g_short_deadline = short_deadline;
+  auto c = peco::tcp_connector::create();
+  bool connected = c->connect("127.0.0.1:12395");
+  assert(connected);
+  peco::ignore_result(connected);
+  std::string data(kDataSize, '\0');
+  for (size_t i = 0; i < kDataSize; ++i) data[i] = (char)('a' + i % 26);
+  std::string received;
+  auto reader = peco::loop::shared()->run([&]() {
+    char buffer[16384];
+    size_t n = 0;
+    while (c->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed) {
+      received.append(buffer, n);
+    }
+  });
+  // Outlive the deadline of the request which starts the relay
+  if (short_deadline) peco::task::this_task().sleep(PECO_TIME_MS(60));
+  bool sent = c->write(data);
+  assert(sent);
+  peco::ignore_result(sent);
+  // Half-close, the echo server sees EOF and says bye
+  ::shutdown(c->native_fd(), SHUT_WR);
+  while (reader.is_alive()) peco::task::this_task().sleep(PECO_TIME_MS(5));
+  assert(received == data + "bye");
+  // Wait for the relay to finish
+  while (g_stats->running > 0) peco::task::this_task().sleep(PECO_TIME_MS(5));
+  peco::log::debug << "relay in_to_out: " << g_stats->in_to_out << ", out_to_in: "
+    << g_stats->out_to_in << ", zero_copy: " << g_stats->zero_copy << std::endl;
+  assert(g_stats->in_to_out == kDataSize);
+  assert(g_stats->out_to_in == kDataSize + 3);
+#if PECO_TARGET_LINUX
+  assert(g_stats->zero_copy == (mode != peco::kRelayModeCopy));
+#endif
+  done_count += 1;
+}
+
+int main() {
+  // Echo server, say bye when the peer stops writing
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12396");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      char buffer[4096];
+      size_t n = 0;
+      while (incoming->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed) {
+        bool echoed = incoming->write(buffer, n);
+        assert(echoed);
+        peco::ignore_result(echoed);
+      }
+      bool bye = incoming->write("bye");
+      assert(bye);
+      peco::ignore_result(bye);
+    });
+  });
+  // Forwarder
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12395");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      auto outgoing = peco::tcp_connector::create();
+      bool connected = outgoing->connect("127.0.0.1:12396");
+      assert(connected);
+      peco::ignore_result(connected);
+      if (g_short_deadline) peco::task::this_task().set_timeout(PECO_TIME_MS(20));
+      g_stats = peco::relay(incoming, outgoing, g_mode);
+    });
+  });
+
+  peco::loop::shared()->run_delay([]() {
+    run_client(peco::kRelayModeAuto);
+    run_client(peco::kRelayModeCopy);
+    run_client(peco::kRelayModeAuto, true);
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(done_count == 3);
+  return 0;
+}
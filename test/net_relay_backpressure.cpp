@@ -0,0 +1,177 @@
+/*
+    net_relay_backpressure.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <sys/socket.h>
+
+const size_t kDataSize = 2 * 1024 * 1024;
+const size_t kBufferSize = 65536;
+std::shared_ptr<peco::relay_stats> g_stats;
+bool g_drain = false;
+// A blocked sink also keeps the relay idle, so stalling needs a longer one
+peco::duration_t g_idle_timeout = PECO_TIME_S(5);
+int done_count = 0;
+
+char pattern(size_t i) {
+  return (char)('a' + i % 26);
+}
+
+void run_backpressure() {
+  auto c = peco::tcp_connector::create();
+  bool connected = c->connect("127.0.0.1:12397");
+  assert(connected);
+  peco::ignore_result(connected);
+  c->set_buffer_size(kBufferSize, kBufferSize);
+  std::string data(kDataSize, '\0');
+  for (size_t i = 0; i < kDataSize; ++i) data[i] = pattern(i);
+
+  // The sink does not read yet, keep writing until nothing is accepted
+  size_t sent = 0;
+  int stalls = 0;
+  while (stalls < 20 && sent < kDataSize) {
+    auto n = c->try_write(data.c_str() + sent, kDataSize - sent);
+    assert(n >= 0);
+    if (n == 0) {
+      stalls += 1;
+      peco::task::this_task().sleep(PECO_TIME_MS(5));
+    } else {
+      stalls = 0;
+      sent += (size_t)n;
+    }
+  }
+  peco::log::debug << "accepted before the sink reads: " << sent
+    << ", relayed: " << g_stats->in_to_out << std::endl;
+  // Only the socket buffers and the relay buffer hold the bytes
+  assert(sent < kDataSize / 2);
+  assert(g_stats->in_to_out <= sent);
+  assert(g_stats->running == 2);
+
+  g_drain = true;
+  bool written = c->write(data.c_str() + sent, kDataSize - sent);
+  assert(written);
+  peco::ignore_result(written);
+  ::shutdown(c->native_fd(), SHUT_WR);
+  std::string received;
+  char buffer[64];
+  size_t n = 0;
+  while (c->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed) {
+    received.append(buffer, n);
+  }
+  assert(received == "ok");
+  while (g_stats->running > 0) peco::task::this_task().sleep(PECO_TIME_MS(5));
+  peco::log::debug << "in_to_out: " << g_stats->in_to_out << ", rate: "
+    << g_stats->in_to_out_rate() << " B/s" << std::endl;
+  assert(g_stats->in_to_out == kDataSize);
+  assert(g_stats->out_to_in == 2);
+  assert(!g_stats->idle_timedout);
+  assert(g_stats->in_to_out_rate() > 0);
+  assert(g_stats->end_time >= g_stats->last_active_time);
+  done_count += 1;
+}
+
+void run_idle() {
+  g_drain = false;
+  g_idle_timeout = PECO_TIME_MS(300);
+  auto c = peco::tcp_connector::create();
+  bool connected = c->connect("127.0.0.1:12397");
+  assert(connected);
+  peco::ignore_result(connected);
+  auto begin = TASK_TIME_NOW();
+  // Nothing moves, the relay gives up and drops both sides
+  auto r = c->read(PECO_TIME_S(3));
+  assert(r.status == peco::kNetOpStatusFailed);
+  assert(TASK_TIME_NOW() - begin < PECO_TIME_S(2));
+  peco::ignore_result(begin);
+  while (g_stats->running > 0) peco::task::this_task().sleep(PECO_TIME_MS(5));
+  assert(g_stats->idle_timedout);
+  assert(g_stats->in_to_out == 0 && g_stats->out_to_in == 0);
+  assert(g_stats->in_to_out_rate() == 0);
+  done_count += 1;
+}
+
+int main() {
+  // Slow sink, only reads after g_drain is set, then checks and says ok
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12398");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      incoming->set_buffer_size(kBufferSize, kBufferSize);
+      while (!g_drain) {
+        if (peco::task::this_task().is_cancelled()) return;
+        peco::task::this_task().sleep(PECO_TIME_MS(5));
+      }
+      char buffer[4096];
+      size_t n = 0;
+      size_t total = 0;
+      while (incoming->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed) {
+        for (size_t i = 0; i < n; ++i) assert(buffer[i] == pattern(total + i));
+        total += n;
+      }
+      assert(total == kDataSize);
+      bool said = incoming->write("ok");
+      assert(said);
+      peco::ignore_result(said);
+    });
+  });
+  // Forwarder with small buffers
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12397");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      incoming->set_buffer_size(kBufferSize, kBufferSize);
+      auto outgoing = peco::tcp_connector::create();
+      bool connected = outgoing->connect("127.0.0.1:12398");
+      assert(connected);
+      peco::ignore_result(connected);
+      outgoing->set_buffer_size(kBufferSize, kBufferSize);
+      peco::relay_options options;
+      options.mode = peco::kRelayModeCopy;
+      options.buffer_size = kBufferSize;
+      options.idle_timeout = g_idle_timeout;
+      g_stats = peco::relay(incoming, outgoing, options);
+    });
+  });
+
+  peco::loop::shared()->run_delay([]() {
+    run_backpressure();
+    run_idle();
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(done_count == 2);
+  return 0;
+}
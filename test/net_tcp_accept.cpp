@@ -0,0 +1,112 @@
+/*
+    net_tcp_accept.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <set>
+
+const int kClientCount = 5;
+const size_t kMaxConnections = 2;
+int g_accepted = 0;
+int g_active = 0;
+int g_max_active = 0;
+int g_slot_exited = 0;
+std::set<uint16_t> g_client_ports;
+std::set<uint16_t> g_peer_ports;
+
+int main() {
+  auto tl = peco::tcp_listener::create();
+  assert(tl->bind("127.0.0.1:12397"));
+  tl->set_max_connections(kMaxConnections);
+  assert(tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+    ++g_accepted;
+    ++g_active;
+    g_max_active = std::max(g_max_active, g_active);
+    g_peer_ports.insert(incoming->peer_info().port);
+    // The slot's own atexit does not break the connection count
+    peco::task::this_task().set_atexit([]() {
+      ++g_slot_exited;
+    });
+#if PECO_TARGET_LINUX
+    // Nonblocking by accept4, nodelay inherited from the listener
+    assert(::fcntl(incoming->native_fd(), F_GETFL) & O_NONBLOCK);
+    int nodelay = 0;
+    socklen_t len = sizeof(nodelay);
+    assert(::getsockopt(incoming->native_fd(), IPPROTO_TCP, TCP_NODELAY, &nodelay, &len) == 0);
+    assert(nodelay != 0);
+#endif
+    // Serve until the client closes
+    char buffer[64];
+    size_t n = 0;
+    while (incoming->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed);
+    --g_active;
+  }));
+
+  peco::loop::shared()->run_delay([tl]() {
+    std::vector<std::shared_ptr<peco::tcp_connector>> clients;
+    for (int i = 0; i < kClientCount; ++i) {
+      auto c = peco::tcp_connector::create();
+      // The handshake is done by the kernel even when not accepted
+      assert(c->connect("127.0.0.1:12397"));
+      g_client_ports.insert(c->localport());
+      clients.push_back(c);
+    }
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+    assert(g_accepted == (int)kMaxConnections);
+    assert(tl->connections() == kMaxConnections);
+
+    // One slot is over, one more connection is accepted
+    ::shutdown(clients[0]->native_fd(), SHUT_WR);
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+    assert(g_accepted == (int)kMaxConnections + 1);
+    assert(tl->connections() == kMaxConnections);
+
+    for (auto& c : clients) ::shutdown(c->native_fd(), SHUT_WR);
+    auto begin = TASK_TIME_NOW();
+    while (tl->connections() > 0 && TASK_TIME_NOW() - begin < PECO_TIME_S(3)) {
+      peco::task::this_task().sleep(PECO_TIME_MS(5));
+    }
+    assert(g_accepted == kClientCount);
+    assert(g_max_active == (int)kMaxConnections);
+    assert(tl->connections() == 0);
+    assert(g_slot_exited == kClientCount);
+    // The peer address comes from accept itself
+    assert(g_peer_ports == g_client_ports);
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(g_accepted == kClientCount);
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+    net_tcp_shard.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if PECO_TARGET_LINUX
+#include <sched.h>
+#endif
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+const int kClientCount = 32;
+
+std::mutex g_lock;
+std::map<std::thread::id, int> g_per_thread;
+std::atomic<int> g_accepted(0);
+
+void wait_for(std::atomic<int>& counter, int expect) {
+  auto begin = TASK_TIME_NOW();
+  while (counter.load() < expect) {
+    bool in_time = (TASK_TIME_NOW() - begin < PECO_TIME_S(5));
+    assert(in_time);
+    if (!in_time) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+// Plain blocking clients, each connection gets a new source port
+void connect_clients(uint16_t port, int count) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+  for (int i = 0; i < count; ++i) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    int ret = ::connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+    assert(ret == 0);
+    peco::ignore_result(ret);
+    ::close(fd);
+  }
+}
+
+std::vector<std::thread::id> loop_threads(std::shared_ptr<peco::shared::loop_group> group) {
+  std::vector<std::thread::id> ids(group->size());
+  for (size_t i = 0; i < group->size(); ++i) {
+    group->at(i)->sync_inject([&ids, i]() {
+      ids[i] = std::this_thread::get_id();
+    });
+  }
+  return ids;
+}
+
+void on_accept(std::shared_ptr<peco::tcp_connector> incoming) {
+  {
+    std::lock_guard<std::mutex> _(g_lock);
+    g_per_thread[std::this_thread::get_id()] += 1;
+  }
+  g_accepted += 1;
+}
+
+int main() {
+  // Hash policy, connections spread to every shard and each is accepted
+  // in the loop owning the shard
+  auto group = peco::shared::loop_group::create(2);
+  auto threads = loop_threads(group);
+  auto hash_listener = peco::tcp_shard_listener::create(group);
+  bool ok = hash_listener->bind("127.0.0.1:12398");
+  assert(ok);
+  peco::ignore_result(ok);
+  assert(hash_listener->size() == 2);
+  ok = hash_listener->listen(on_accept);
+  assert(ok);
+  // The listening address is taken by the group only
+  auto other = peco::tcp_listener::create();
+  bool taken = !other->bind("127.0.0.1:12398");
+  assert(taken);
+  peco::ignore_result(taken);
+  connect_clients(12398, kClientCount);
+  wait_for(g_accepted, kClientCount);
+  assert(g_per_thread.size() == 2);
+  for (const auto& kv : g_per_thread) {
+    assert(kv.first == threads[0] || kv.first == threads[1]);
+    assert(kv.second > 0);
+    peco::ignore_result(kv);
+  }
+
+#if PECO_TARGET_LINUX
+  // Cpu policy, a client pinned to cpu 0 always reaches shard 0
+  g_accepted = 0;
+  g_per_thread.clear();
+  auto cpu_group = peco::shared::loop_group::create_pinned({0, 0});
+  auto cpu_threads = loop_threads(cpu_group);
+  auto cpu_listener = peco::tcp_shard_listener::create(cpu_group, peco::kShardPolicyCpu);
+  bool cpu_ok = cpu_listener->bind("127.0.0.1:12399");
+  assert(cpu_ok);
+  peco::ignore_result(cpu_ok);
+  cpu_ok = cpu_listener->listen(on_accept);
+  assert(cpu_ok);
+  std::thread client([]() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(0, &set);
+    int ret = ::sched_setaffinity(0, sizeof(set), &set);
+    assert(ret == 0);
+    peco::ignore_result(ret);
+    connect_clients(12399, kClientCount);
+  });
+  client.join();
+  wait_for(g_accepted, kClientCount);
+  assert(g_per_thread.size() == 1);
+  assert(g_per_thread.begin()->first == cpu_threads[0]);
+#endif
+  peco::log::debug << "tcp shard test done" << std::endl;
+  return 0;
+}
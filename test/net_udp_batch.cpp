@@ -0,0 +1,149 @@
+/*
+    net_udp_batch.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+#include <sys/socket.h>
+
+// Count the batched syscalls
+static int g_sendmmsg_calls = 0;
+static int g_recvmmsg_calls = 0;
+extern "C" int sendmmsg(int fd, struct mmsghdr* msgs, unsigned int vlen, int flags) {
+  typedef int (*sendmmsg_t)(int, struct mmsghdr*, unsigned int, int);
+  static sendmmsg_t real_sendmmsg = (sendmmsg_t)dlsym(RTLD_NEXT, "sendmmsg");
+  ++g_sendmmsg_calls;
+  return real_sendmmsg(fd, msgs, vlen, flags);
+}
+extern "C" int recvmmsg(int fd, struct mmsghdr* msgs, unsigned int vlen, int flags,
+  struct timespec* timeout) {
+  typedef int (*recvmmsg_t)(int, struct mmsghdr*, unsigned int, int, struct timespec*);
+  static recvmmsg_t real_recvmmsg = (recvmmsg_t)dlsym(RTLD_NEXT, "recvmmsg");
+  int ret = real_recvmmsg(fd, msgs, vlen, flags, timeout);
+  if (ret > 0) ++g_recvmmsg_calls;
+  return ret;
+}
+
+const int kRoundCount = 10;
+const int kRoundPackets = 50;
+int g_echoed = 0;
+int g_replied = 0;
+bool g_checked = true;
+std::vector<std::pair<size_t, bool>> g_received;
+
+int main() {
+  // Echo server, replies go out together when the loop goes idle
+  auto server = peco::udp_listener::create();
+  assert(server->bind("127.0.0.1:12395"));
+  auto server_box = peco::udp_outbox::create(server);
+  assert(server->listen_batch([&](const peco::udp_datagram* datagrams, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      assert(server_box->writeto(datagrams[i].peer, datagrams[i].data, datagrams[i].length));
+    }
+    g_echoed += (int)count;
+  }));
+
+  auto client = peco::udp_listener::create();
+  assert(client->bind("127.0.0.1:12396"));
+  auto client_box = peco::udp_outbox::create(client);
+  assert(client->listen_batch([&](const peco::udp_datagram* datagrams, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      std::string expect = "packet-" + std::to_string(g_replied + (int)i);
+      if (std::string(datagrams[i].data, datagrams[i].length) != expect) g_checked = false;
+    }
+    g_replied += (int)count;
+  }));
+
+  peco::loop::shared()->run_delay([&]() {
+    peco::peer_t server_addr("127.0.0.1:12395");
+    for (int r = 0; r < kRoundCount; ++r) {
+      for (int i = 0; i < kRoundPackets; ++i) {
+        std::string data = "packet-" + std::to_string(r * kRoundPackets + i);
+        assert(client_box->writeto(server_addr, data));
+      }
+      assert(client_box->pending() == (size_t)kRoundPackets);
+      int expect = (r + 1) * kRoundPackets;
+      auto begin = TASK_TIME_NOW();
+      while (g_replied < expect && TASK_TIME_NOW() - begin < PECO_TIME_S(3)) {
+        peco::task::this_task().sleep(PECO_TIME_MS(1));
+      }
+      assert(g_replied == expect);
+    }
+    assert(g_echoed == kRoundCount * kRoundPackets);
+    assert(g_checked);
+    peco::log::debug << "packets: " << kRoundCount * kRoundPackets * 2
+      << ", sendmmsg: " << g_sendmmsg_calls << ", recvmmsg: " << g_recvmmsg_calls << std::endl;
+#if PECO_TARGET_LINUX
+    // One syscall per side per round
+    assert(g_sendmmsg_calls <= kRoundCount * 2 * 2);
+    assert(g_recvmmsg_calls <= kRoundCount * 2 * 2);
+#endif
+    // The flush in a task sends at once
+    assert(client_box->writeto(server_addr, "packet-" + std::to_string(g_replied)));
+    assert(client_box->flush());
+    assert(client_box->pending() == 0);
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+    assert(g_replied == kRoundCount * kRoundPackets + 1);
+
+#if PECO_TARGET_LINUX
+    // Coalesced datagrams of GRO do not fit the batch arena
+    auto gro_listener = peco::udp_listener::create();
+    assert(gro_listener->bind("127.0.0.1:12398"));
+    assert(gro_listener->set_gro(true));
+    assert(!gro_listener->listen_batch([](const peco::udp_datagram*, size_t) {}));
+
+    // The outbox keeps one datagram per writeto with GSO on, and the
+    // longer datagram is marked as truncated
+    auto receiver = peco::udp_listener::create();
+    assert(receiver->bind("127.0.0.1:12397"));
+    assert(receiver->listen_batch([&](const peco::udp_datagram* datagrams, size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        g_received.emplace_back(datagrams[i].length, datagrams[i].truncated);
+      }
+    }));
+    assert(!receiver->set_gro(true));
+    assert(server->set_gso(500));
+    peco::peer_t receiver_addr("127.0.0.1:12397");
+    assert(server_box->writeto(receiver_addr, std::string(1400, 'a')));
+    assert(server_box->writeto(receiver_addr, std::string(PECO_NET_UDP_PACKET_SIZE + 100, 'b')));
+    assert(server_box->flush());
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+    assert(g_received.size() == 2);
+    assert(g_received[0].first == 1400 && !g_received[0].second);
+    assert(g_received[1].first == PECO_NET_UDP_PACKET_SIZE && g_received[1].second);
+#endif
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(g_replied == kRoundCount * kRoundPackets + 1);
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+    net_zero_copy.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <dlfcn.h>
+#include <sys/socket.h>
+
+// Count the sends with MSG_ZEROCOPY
+static int g_zero_copy_sends = 0;
+extern "C" ssize_t send(int fd, const void* buf, size_t len, int flags) {
+  typedef ssize_t (*send_t)(int, const void*, size_t, int);
+  static send_t real_send = (send_t)dlsym(RTLD_NEXT, "send");
+  if (flags & MSG_ZEROCOPY) ++g_zero_copy_sends;
+  return real_send(fd, buf, len, flags);
+}
+
+const size_t kLargeSize = 4 * 1024 * 1024;
+const size_t kSmallSize = 1024;
+int done_count = 0;
+
+char pattern(size_t i) {
+  return (char)('a' + i % 26);
+}
+
+int main() {
+  // Sink, check all bytes then say ok
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12399");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      char buffer[16384];
+      size_t n = 0;
+      size_t total = 0;
+      while (incoming->read_into(buffer, sizeof(buffer), n) != peco::kNetOpStatusFailed) {
+        for (size_t i = 0; i < n; ++i) assert(buffer[i] == pattern(total + i));
+        total += n;
+      }
+      assert(total == kLargeSize * 2 + kSmallSize);
+      bool said = incoming->write("ok");
+      assert(said);
+      peco::ignore_result(said);
+    });
+  });
+
+  peco::loop::shared()->run_delay([]() {
+    auto c = peco::tcp_connector::create();
+    bool connected = c->connect("127.0.0.1:12399");
+    assert(connected);
+    peco::ignore_result(connected);
+    if (!c->set_zero_copy(true)) {
+      peco::log::info << "zero-copy is not supported, skip" << std::endl;
+      done_count += 1;
+      peco::loop::shared()->exit();
+      return;
+    }
+    assert(c->is_zero_copy());
+    // The completions must not break a task reading the same socket
+    std::string received;
+    auto reader = peco::loop::shared()->run([&]() {
+      auto r = c->read(PECO_TIME_S(10));
+      assert(r.status == peco::kNetOpStatusOK);
+      received = r.data;
+    });
+
+    std::string data(kLargeSize, '\0');
+    for (size_t i = 0; i < kLargeSize; ++i) data[i] = pattern(i);
+    bool sent = c->write(data);
+    assert(sent);
+    peco::ignore_result(sent);
+    int large_sends = g_zero_copy_sends;
+    assert(large_sends > 0);
+    // The kernel has released the data, reuse the buffer at once
+    for (size_t i = 0; i < kLargeSize; ++i) data[i] = pattern(kLargeSize + i);
+    sent = c->write(data);
+    assert(sent);
+    assert(g_zero_copy_sends > large_sends);
+    peco::ignore_result(large_sends);
+
+    // Small writes take the copy path
+    int before_small = g_zero_copy_sends;
+    std::string small(kSmallSize, '\0');
+    for (size_t i = 0; i < kSmallSize; ++i) small[i] = pattern(kLargeSize * 2 + i);
+    sent = c->write(small);
+    assert(sent);
+    assert(g_zero_copy_sends == before_small);
+    peco::ignore_result(before_small);
+    peco::log::debug << "zero-copy sends: " << g_zero_copy_sends << std::endl;
+
+    ::shutdown(c->native_fd(), SHUT_WR);
+    while (reader.is_alive()) peco::task::this_task().sleep(PECO_TIME_MS(5));
+    assert(received == "ok");
+    done_count += 1;
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(done_count == 1);
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+    task_deadline.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#define ELAPSED_MS(b) std::chrono::duration_cast<std::chrono::milliseconds>(TASK_TIME_NOW() - (b)).count()
+
+bool child_done = false;
+bool net_done = false;
+bool late_accepted = false;
+
+int main() {
+  // No deadline by default
+  peco::loop::shared()->run([]() {
+    assert(peco::task::this_task().deadline() == peco::task_time_t::max());
+    assert(!peco::task::this_task().is_deadline_exceeded());
+  });
+
+  peco::loop::shared()->run([]() {
+    auto begin = TASK_TIME_NOW();
+    peco::task::this_task().set_timeout(PECO_TIME_MS(50));
+    auto deadline = peco::task::this_task().deadline();
+    // Child task inherits the deadline, long waits are clamped
+    peco::loop::shared()->run([deadline, begin]() {
+      assert(peco::task::this_task().deadline() == deadline);
+      bool r = peco::task::this_task().holding_until(PECO_TIME_S(10));
+      assert(!r);
+      peco::ignore_result(r);
+      assert(peco::task::this_task().is_deadline_exceeded());
+      assert(ELAPSED_MS(begin) < 1000);
+      child_done = true;
+    });
+    // Sleep stops at the deadline
+    peco::task::this_task().sleep(PECO_TIME_S(10));
+    peco::log::debug << "sleep cost: " << ELAPSED_MS(begin) << "ms" << std::endl;
+    assert(peco::task::this_task().is_deadline_exceeded());
+    assert(ELAPSED_MS(begin) >= 50 && ELAPSED_MS(begin) < 1000);
+  });
+
+  // A server which never responds
+  peco::loop::shared()->run([]() {
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12399");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      peco::task::this_task().sleep(PECO_TIME_MS(500));
+    });
+  });
+
+  peco::loop::shared()->run_delay([]() {
+    auto c = peco::tcp_connector::create();
+    bool connected = c->connect("127.0.0.1:12399");
+    assert(connected);
+    auto begin = TASK_TIME_NOW();
+    peco::task::this_task().set_timeout(PECO_TIME_MS(30));
+    // The read's own timeout is 10s, clamped to the deadline
+    auto r = c->read();
+    peco::log::debug << "read cost: " << ELAPSED_MS(begin) << "ms" << std::endl;
+    assert(r.status == peco::kNetOpStatusTimedout);
+    assert(ELAPSED_MS(begin) >= 30 && ELAPSED_MS(begin) < 1000);
+    // Already missed the deadline, stop right away
+    begin = TASK_TIME_NOW();
+    bool written = c->write("hello peco", 10);
+    auto status = c->read().status;
+    auto c2 = peco::tcp_connector::create();
+    connected = c2->connect("127.0.0.1:12399");
+    assert(!written);
+    assert(status == peco::kNetOpStatusTimedout);
+    assert(!connected);
+    assert(ELAPSED_MS(begin) < 5);
+    peco::ignore_result(written);
+    peco::ignore_result(status);
+    peco::ignore_result(connected);
+    net_done = true;
+  }, PECO_TIME_MS(10));
+
+  // A listener started by a request which has missed its deadline keeps
+  // accepting, instead of spinning on zero timeouts
+  peco::loop::shared()->run([]() {
+    peco::task::this_task().set_timeout(PECO_TIME_MS(1));
+    peco::task::this_task().sleep(PECO_TIME_MS(5));
+    assert(peco::task::this_task().is_deadline_exceeded());
+    auto tl = peco::tcp_listener::create();
+    bool bound = tl->bind("127.0.0.1:12398");
+    assert(bound);
+    peco::ignore_result(bound);
+    tl->listen([](std::shared_ptr<peco::tcp_connector> incoming) {
+      late_accepted = true;
+    });
+  });
+  peco::loop::shared()->run_delay([]() {
+    auto c = peco::tcp_connector::create();
+    bool connected = c->connect("127.0.0.1:12398");
+    assert(connected);
+    peco::ignore_result(connected);
+    peco::task::this_task().sleep(PECO_TIME_MS(50));
+    assert(late_accepted);
+  }, PECO_TIME_MS(100));
+
+  auto exit_begin = TASK_TIME_NOW();
+  peco::loop::shared()->run_delay([]() {
+    peco::loop::shared()->exit();
+  }, PECO_TIME_MS(800));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(child_done);
+  assert(net_done);
+  assert(late_accepted);
+  // The exit is not held back by any spinning task
+  assert(ELAPSED_MS(exit_begin) < 1500);
+  peco::ignore_result(exit_begin);
+  return 0;
+}
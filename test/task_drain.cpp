@@ -0,0 +1,111 @@
+/*
+    task_drain.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+int finished_count = 0;
+int cancelled_count = 0;
+bool listener_stopped = false;
+
+int main() {
+  // A listener keeps accepting until cancelled
+  peco::loop::shared()->run([]() {
+    peco::task::this_task().set_listener();
+    while (!peco::task::this_task().is_cancelled()) {
+      peco::task::this_task().sleep(PECO_TIME_MS(5));
+    }
+    listener_stopped = true;
+  });
+  // In-flight requests, finish before the deadline
+  for (int i = 1; i <= 3; ++i) {
+    peco::loop::shared()->run([i]() {
+      peco::task::this_task().sleep(PECO_TIME_MS(10 * i));
+      if (!peco::task::this_task().is_cancelled()) finished_count += 1;
+    });
+  }
+  // Stuck requests, will be forced
+  for (int i = 0; i < 2; ++i) {
+    peco::loop::shared()->run([]() {
+      peco::task::this_task().holding();
+      if (peco::task::this_task().is_cancelled()) cancelled_count += 1;
+    });
+  }
+
+  peco::loop::shared()->run([]() {
+    peco::task::this_task().sleep(PECO_TIME_MS(1));
+    auto begin = TASK_TIME_NOW();
+    auto forced = peco::loop::shared()->drain(PECO_TIME_MS(100));
+    auto cost = TASK_TIME_NOW() - begin;
+    peco::log::debug << "forced: " << forced << ", cost: "
+      << std::chrono::duration_cast<std::chrono::milliseconds>(cost).count() << "ms" << std::endl;
+    assert(listener_stopped);
+    assert(finished_count == 3);
+    assert(forced == 2);
+    assert(cost >= PECO_TIME_MS(100));
+
+    // Nothing left, drain returns at once
+    peco::loop::shared()->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_MS(5));
+    });
+    begin = TASK_TIME_NOW();
+    forced = peco::loop::shared()->drain(PECO_TIME_MS(1000));
+    assert(forced == 0);
+    assert(TASK_TIME_NOW() - begin < PECO_TIME_MS(500));
+  });
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(cancelled_count == 2);
+
+  // Drain a shared loop from another thread, the loop exits after it
+  auto sl = peco::shared::loop::create();
+  sl->run([]() {
+    peco::task::this_task().holding();
+  });
+  assert(sl->drain(PECO_TIME_MS(20)) == 1);
+
+  // Timers are dropped by the draining, the loop exits after it
+  auto timer_loop = peco::shared::loop::create();
+  timer_loop->sync_inject([]() {
+    peco::loop::shared()->call_every([]() {}, PECO_TIME_MS(5));
+  });
+  assert(timer_loop->drain(PECO_TIME_MS(20)) == 0);
+  timer_loop = nullptr;
+
+  // A forced task leaves a timer when exiting, the loop is interrupted
+  // on destroying
+  auto left_loop = peco::shared::loop::create();
+  left_loop->run([]() {
+    peco::task::this_task().holding();
+    peco::loop::shared()->call_every([]() {}, PECO_TIME_MS(5));
+  });
+  assert(left_loop->drain(PECO_TIME_MS(20)) == 1);
+  left_loop = nullptr;
+  return 0;
+}
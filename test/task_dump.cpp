@@ -0,0 +1,138 @@
+/*
+    task_dump.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+std::string dump;
+
+// Yield with a deep stack
+size_t deep_yield(size_t depth) {
+  volatile char frame[1024];
+  frame[0] = (char)depth;
+  if (depth == 0) {
+    peco::task::this_task().sleep(PECO_TIME_MS(1));
+    return frame[0];
+  }
+  return deep_yield(depth - 1) + frame[0];
+}
+
+std::string find_line(const std::string& name) {
+  auto b = dump.find("name: " + name + ",");
+  assert(b != std::string::npos);
+  b = dump.rfind('\n', b) + 1;
+  return dump.substr(b, dump.find('\n', b) - b);
+}
+
+int main() {
+  int fds[2];
+  int ret = pipe(fds);
+  assert(ret == 0);
+  peco::ignore_result(ret);
+
+  // Dumped on SIGUSR1 through the loop
+  peco::loop::shared()->on_signal(SIGUSR1, [](int) {
+    dump = peco::loop::shared()->dump_tasks();
+    peco::log::info << dump;
+  });
+
+  auto reader = peco::loop::shared()->run([fds]() {
+    peco::task::this_task().wait_fd_for_event(fds[0], peco::kEventTypeRead, PECO_TIME_S(10));
+  }, "reader");
+  auto sleeper = peco::loop::shared()->run([]() {
+    peco::task::this_task().sleep(PECO_TIME_S(10));
+  }, "sleeper");
+  auto holder = peco::loop::shared()->run([]() {
+    peco::task::this_task().holding();
+  }, "holder");
+  peco::loop::shared()->run([]() {
+    peco::ignore_result(deep_yield(64));
+  }, "deep");
+
+  peco::loop::shared()->run([=]() mutable {
+    peco::task::this_task().set_name("main");
+    peco::task::this_task().sleep(PECO_TIME_MS(20));
+    kill(getpid(), SIGUSR1);
+    peco::task::this_task().sleep(PECO_TIME_MS(5));
+    assert(dump.size() > 0);
+
+    auto l = find_line("reader");
+    assert(l.find("status: paused") != std::string::npos);
+    assert(l.find("wait: fd(" + std::to_string(fds[0]) + ") read") != std::string::npos);
+    assert(l.find("parent: none") != std::string::npos);
+    l = find_line("sleeper");
+    assert(l.find("wait: timer") != std::string::npos);
+    l = find_line("holder");
+    assert(l.find("wait: hold") != std::string::npos);
+    assert(l.find("ms ago") != std::string::npos);
+    l = find_line("main");
+    assert(l.find("wait: timer") != std::string::npos);
+    // The deep task has gone
+    assert(dump.find("name: deep,") == std::string::npos);
+
+    reader.cancel();
+    sleeper.cancel();
+    holder.cancel();
+  });
+
+  // Stack of a finished task can not be dumped, check a live one
+  peco::loop::shared()->run([]() {
+    peco::loop::shared()->run([]() {
+      peco::ignore_result(deep_yield(64));
+    }, "deep2");
+    peco::task::this_task().yield();
+    peco::loop::shared()->run([]() {}, "never");
+    dump = peco::loop::shared()->dump_tasks();
+    auto l = find_line("deep2");
+    auto depth = std::stoul(l.substr(l.find("stack at suspend: ") + 18));
+    assert(depth > 64 * 1024);
+    peco::ignore_result(depth);
+    l = find_line("never");
+    assert(l.find("wait: start") != std::string::npos);
+    assert(l.find("last run: never") != std::string::npos);
+    assert(l.find("parent: none") == std::string::npos);
+  });
+
+  peco::ignore_result(peco::loop::shared()->main());
+  close(fds[0]);
+  close(fds[1]);
+
+  // Through a shared loop
+  auto sl = peco::shared::loop::create();
+  sl->run([]() {
+    peco::task::this_task().sleep(PECO_TIME_MS(100));
+  }, "shared_sleeper");
+  auto shared_dump = sl->dump_tasks();
+  assert(shared_dump.find("name: shared_sleeper,") != std::string::npos);
+  return 0;
+}
@@ -0,0 +1,119 @@
+/*
+    task_group.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+int finished_count = 0;
+bool orphan_cancelled = false;
+
+int main() {
+  // Join all children
+  peco::loop::shared()->run([]() {
+    auto group = peco::task_group::create();
+    for (int i = 1; i <= 3; ++i) {
+      group->run([i]() {
+        peco::task::this_task().sleep(PECO_TIME_MS(10 * i));
+        finished_count += 1;
+        return true;
+      });
+    }
+    assert(group->size() == 3);
+    bool joined = group->join();
+    assert(joined);
+    peco::ignore_result(joined);
+    assert(group->size() == 0);
+    assert(finished_count == 3);
+    peco::log::debug << "join all done" << std::endl;
+  });
+
+  // First error cancels the siblings
+  peco::loop::shared()->run([]() {
+    auto group = peco::task_group::create(peco::kGroupPolicyFirstError);
+    auto begin = TASK_TIME_NOW();
+    auto failed = group->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_MS(10));
+      return false;
+    });
+    group->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_S(10));
+      return peco::task::this_task().is_cancelled() == false;
+    });
+    bool stopped = !group->join();
+    assert(stopped);
+    peco::ignore_result(stopped);
+    assert(group->is_cancelled());
+    assert(group->first_error() == failed.task_id());
+    assert(TASK_TIME_NOW() - begin < PECO_TIME_S(1));
+    peco::ignore_result(begin);
+    peco::log::debug << "first error done" << std::endl;
+  });
+
+  // First result cancels the siblings
+  peco::loop::shared()->run([]() {
+    auto group = peco::task_group::create(peco::kGroupPolicyFirstResult);
+    group->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_S(10));
+      return !peco::task::this_task().is_cancelled();
+    });
+    auto fast = group->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_MS(5));
+      return true;
+    });
+    bool joined = group->join_until(PECO_TIME_S(1));
+    assert(joined);
+    peco::ignore_result(joined);
+    assert(group->first_result() == fast.task_id());
+    peco::log::debug << "first result done" << std::endl;
+  });
+
+  // Cancel the owner when joining, all children will be cancelled
+  auto owner = peco::loop::shared()->run([]() {
+    auto group = peco::task_group::create();
+    group->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_S(10));
+      orphan_cancelled = peco::task::this_task().is_cancelled();
+      return true;
+    });
+    bool stopped = !group->join();
+    assert(stopped);
+    peco::ignore_result(stopped);
+  });
+  peco::loop::shared()->run_delay([owner]() {
+    peco::task(owner).cancel();
+  }, PECO_TIME_MS(10));
+
+  auto begin = TASK_TIME_NOW();
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(orphan_cancelled);
+  assert(TASK_TIME_NOW() - begin < PECO_TIME_S(5));
+  peco::ignore_result(begin);
+  return 0;
+}
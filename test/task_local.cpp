@@ -0,0 +1,109 @@
+/*
+    task_local.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <string>
+
+struct trace_context {
+  std::string trace_id;
+  int depth = 0;
+  ~trace_context() {
+    destroyed_count += 1;
+  }
+  static int destroyed_count;
+};
+int trace_context::destroyed_count = 0;
+
+// Too large to be placed in the reserved region, will be stored on heap
+struct large_context {
+  char data[16384];
+  ~large_context() {
+    destroyed_count += 1;
+  }
+  static int destroyed_count;
+};
+int large_context::destroyed_count = 0;
+
+peco::task_local<trace_context> g_trace;
+peco::task_local<int> g_counter;
+peco::task_local<large_context> g_large;
+
+void check_trace(const std::string& id) {
+  auto ctx = g_trace.get();
+  assert(ctx != nullptr);
+  ctx->trace_id = id;
+  for (int i = 0; i < 10; ++i) {
+    *g_counter.get() += 1;
+    peco::task::this_task().yield();
+    // Other tasks will not change my value
+    assert(g_trace.get()->trace_id == id);
+  }
+  assert(*g_counter.get() == 10);
+}
+
+int main() {
+  // No task, no value
+  assert(g_trace.get() == nullptr);
+  assert(!g_counter.has());
+
+  peco::loop::shared()->run([]() {
+    check_trace("first");
+  });
+  peco::loop::shared()->run([]() {
+    check_trace("second");
+    assert(g_counter.has());
+    g_counter.reset();
+    assert(!g_counter.has());
+    // Reconstructed with default value
+    assert(*g_counter.get() == 0);
+  });
+  peco::loop::shared()->run([]() {
+    assert(!g_large.has());
+    g_large.get()->data[16383] = 'x';
+    peco::task::this_task().sleep(PECO_TIME_MS(1));
+    assert(g_large.get()->data[16383] == 'x');
+  });
+  peco::loop::shared()->run([]() {
+    // Set will construct the value
+    g_trace.set(trace_context());
+    g_trace.get()->depth = 3;
+    g_trace.reset();
+  });
+  peco::ignore_result(peco::loop::shared()->main());
+
+  peco::log::debug << "trace destroyed: " << trace_context::destroyed_count
+    << ", large destroyed: " << large_context::destroyed_count << std::endl;
+  // 2 values destroyed at task exit, 1 reset and 1 temp object in set
+  assert(trace_context::destroyed_count == 4);
+  assert(large_context::destroyed_count == 1);
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+    task_loop_group.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+const int kSubmitCount = 100;
+
+void wait_for(std::atomic<int>& counter, int expect) {
+  auto begin = TASK_TIME_NOW();
+  while (counter.load() < expect) {
+    bool in_time = (TASK_TIME_NOW() - begin < PECO_TIME_S(5));
+    assert(in_time);
+    if (!in_time) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+int main() {
+  std::vector<int> cpus{0, (peco::cpu_count() > 1 ? 1 : 0)};
+
+  // Round robin, each loop gets the same count of workers
+  auto rr_group = peco::shared::loop_group::create_pinned(cpus, peco::shared::kPlacementRoundRobin);
+  assert(rr_group->size() == 2);
+  std::atomic<int> done(0);
+  std::mutex lock;
+  std::map<std::thread::id, int> per_thread;
+  for (int i = 0; i < kSubmitCount; ++i) {
+    rr_group->submit([&]() {
+      {
+        std::lock_guard<std::mutex> _(lock);
+        per_thread[std::this_thread::get_id()] += 1;
+      }
+      done += 1;
+    });
+  }
+  wait_for(done, kSubmitCount);
+  assert(per_thread.size() == 2);
+  for (const auto& kv : per_thread) {
+    assert(kv.second == kSubmitCount / 2);
+    peco::ignore_result(kv);
+  }
+
+  // Least loaded, long workers on loop 0 push new workers to loop 1
+  auto ll_group = peco::shared::loop_group::create(2);
+  std::atomic<int> started(0);
+  std::atomic<bool> release(false);
+  ll_group->submit_to(0, [&]() {
+    started += 1;
+    while (!release.load()) {
+      peco::task::this_task().sleep(PECO_TIME_MS(1));
+    }
+  });
+  wait_for(started, 1);
+  assert(ll_group->load(0) == 1);
+  for (int i = 0; i < 10; ++i) {
+    assert(ll_group->pick() == 1);
+  }
+  release = true;
+  auto begin = TASK_TIME_NOW();
+  while (ll_group->load(0) != 0) {
+    bool in_time = (TASK_TIME_NOW() - begin < PECO_TIME_S(5));
+    assert(in_time);
+    if (!in_time) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  assert(ll_group->load(0) == 0);
+
+  // A worker dropped by a drained loop gives its load back
+  ll_group->at(1)->drain(PECO_TIME_MS(100));
+  bool ran = false;
+  ll_group->submit_to(1, [&]() { ran = true; });
+  assert(ll_group->load(1) == 0);
+  assert(!ran);
+  peco::ignore_result(ran);
+  peco::log::debug << "loop group test done" << std::endl;
+  return 0;
+}
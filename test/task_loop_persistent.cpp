@@ -0,0 +1,78 @@
+/*
+    task_loop_persistent.cpp
+    libpeco
+    2022-02-13
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+int repeat_count = 0;
+const int max_repeat_count = 10;
+int outer_count = 0;
+
+void peco_loop_task() {
+  if (peco::task::this_task().is_cancelled()) {
+    // Will never been invoked
+    assert(0);
+  }
+  repeat_count += 1;
+  peco::log::debug << "in persistent loop: " << repeat_count << std::endl;
+  // The worker can block between fires
+  peco::task::this_task().sleep(PECO_TIME_MS(1));
+  if (repeat_count == max_repeat_count / 2) {
+    peco::task::this_task().update_interval(PECO_TIME_MS(2));
+  }
+  if (repeat_count == max_repeat_count) {
+    peco::task::this_task().cancel();
+  }
+}
+
+int main() {
+  auto t = peco::loop::shared()->run_loop(peco_loop_task, PECO_TIME_MS(5), peco::kRepeatModePersistent);
+  auto begin = TASK_TIME_NOW();
+
+  // Cancelled by others while parking
+  auto outer = peco::loop::shared()->run_loop([]() {
+    outer_count += 1;
+  }, PECO_TIME_MS(3), peco::kRepeatModePersistent, "outer");
+  peco::loop::shared()->run_delay([outer]() mutable {
+    assert(outer.is_alive());
+    outer.cancel();
+  }, PECO_TIME_MS(10));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  auto cost = TASK_TIME_NOW() - begin;
+  peco::log::debug << "repeat_count: " << repeat_count << ", outer_count: " << outer_count
+    << ", cost: " << std::chrono::duration_cast<std::chrono::milliseconds>(cost).count() << "ms" << std::endl;
+  assert(repeat_count == max_repeat_count);
+  assert(outer_count == 3);
+  assert(!t.is_alive());
+  // 5 fires on 5ms then 5 fires on 2ms
+  assert(cost >= PECO_TIME_MS(5 * 5 + 4 * 2));
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+    task_on_signal.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+int usr1_count = 0;
+int hup_count = 0;
+
+int main() {
+  // Registered before the loop starts
+  bool ret = peco::loop::shared()->on_signal(SIGUSR1, [](int signo) {
+    assert(signo == SIGUSR1);
+    // Handler runs as a normal task
+    assert(peco::task::this_task().is_alive());
+    // So it can block
+    peco::task::this_task().sleep(PECO_TIME_MS(1));
+    usr1_count += 1;
+    peco::log::debug << "got SIGUSR1" << std::endl;
+  });
+  assert(ret);
+  peco::ignore_result(ret);
+
+  peco::loop::shared()->run([]() {
+    // Registered inside the loop
+    peco::loop::shared()->on_signal(SIGHUP, [](int signo) {
+      assert(signo == SIGHUP);
+      hup_count += 1;
+      peco::log::debug << "got SIGHUP" << std::endl;
+    });
+    kill(getpid(), SIGUSR1);
+    peco::task::this_task().sleep(PECO_TIME_MS(20));
+    assert(usr1_count == 1);
+
+    kill(getpid(), SIGHUP);
+    kill(getpid(), SIGUSR1);
+    peco::task::this_task().sleep(PECO_TIME_MS(20));
+    assert(hup_count == 1);
+    assert(usr1_count == 2);
+
+    // Removed handler will not be invoked anymore
+    peco::loop::shared()->on_signal(SIGHUP, nullptr);
+    peco::loop::shared()->on_signal(SIGHUP, [](int) {
+      hup_count += 1;
+    });
+    peco::loop::shared()->on_signal(SIGHUP, nullptr);
+    peco::task::this_task().sleep(PECO_TIME_MS(5));
+    assert(hup_count == 1);
+  });
+
+  // Signal handlers do not keep the loop alive
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(usr1_count == 2);
+  assert(hup_count == 1);
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+    task_priority.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <vector>
+
+std::vector<int> run_order;
+bool high_running = true;
+int low_runs_while_high = 0;
+
+void burn(peco::duration_t d) {
+  auto end_time = TASK_TIME_NOW() + d;
+  while (TASK_TIME_NOW() < end_time);
+}
+
+int main() {
+  // All three tasks are ready in the same loop pass, high priority first
+  auto low = peco::loop::shared()->run([]() {
+    run_order.push_back(peco::kTaskPriorityLow);
+  });
+  low.set_priority(peco::kTaskPriorityLow);
+  peco::loop::shared()->run([]() {
+    run_order.push_back(peco::kTaskPriorityNormal);
+  });
+  auto high = peco::loop::shared()->run([]() {
+    run_order.push_back(peco::kTaskPriorityHigh);
+  });
+  high.set_priority(peco::kTaskPriorityHigh);
+  assert(high.priority() == peco::kTaskPriorityHigh);
+  peco::ignore_result(peco::loop::shared()->main());
+
+  assert(run_order.size() == 3);
+  assert(run_order[0] == peco::kTaskPriorityHigh);
+  assert(run_order[1] == peco::kTaskPriorityNormal);
+  assert(run_order[2] == peco::kTaskPriorityLow);
+
+  // High priority tasks keep yielding, low priority task must not starve
+  for (int i = 0; i < 4; ++i) {
+    auto t = peco::loop::shared()->run([]() {
+      auto end_time = TASK_TIME_NOW() + PECO_TIME_MS(200);
+      while (TASK_TIME_NOW() < end_time) {
+        burn(PECO_TIME_MS(1));
+        peco::task::this_task().yield();
+      }
+      high_running = false;
+    });
+    t.set_priority(peco::kTaskPriorityHigh);
+  }
+  auto starving = peco::loop::shared()->run([]() {
+    while (high_running) {
+      ++low_runs_while_high;
+      peco::task::this_task().yield();
+    }
+  });
+  starving.set_priority(peco::kTaskPriorityLow);
+  peco::ignore_result(peco::loop::shared()->main());
+
+  peco::log::debug << "low task runs while high tasks flooding: " << low_runs_while_high << std::endl;
+  assert(low_runs_while_high > 1);
+  assert(peco::loop::shared()->priority_time(peco::kTaskPriorityHigh) > PECO_TIME_MS(100));
+  return 0;
+}
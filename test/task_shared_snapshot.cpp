@@ -0,0 +1,69 @@
+/*
+    task_shared_snapshot.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <thread>
+
+int main() {
+  auto sl = peco::shared::loop::create();
+  auto t = sl->run([]() {
+    while (!peco::task::this_task().is_cancelled()) {
+      peco::task::this_task().sleep(PECO_TIME_MS(1));
+    }
+  }, "snapshot_task");
+
+  // All reads below do not inject into the shared loop
+  assert(std::string(t.get_name()) == "snapshot_task");
+  assert(t.is_alive());
+  assert(!t.is_cancelled());
+  size_t polls = 0;
+  auto begin = TASK_TIME_NOW();
+  while (TASK_TIME_NOW() - begin < PECO_TIME_MS(50)) {
+    auto status = t.status();
+    assert(status != peco::kTaskStatusStopped);
+    peco::ignore_result(status);
+    ++polls;
+  }
+  peco::log::debug << "polled status " << polls << " times in 50ms" << std::endl;
+
+  // cancel will not block, and the flag is visible at once
+  t.cancel();
+  assert(t.is_cancelled());
+  t.cancel();
+  begin = TASK_TIME_NOW();
+  while (t.is_alive()) {
+    assert(TASK_TIME_NOW() - begin < PECO_TIME_S(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  assert(t.status() == peco::kTaskStatusStopped);
+  return 0;
+}
@@ -0,0 +1,80 @@
+/*
+    task_timer.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+int later_count = 0;
+int every_count = 0;
+const int max_every_count = 10;
+
+int main() {
+  // one shot timer
+  peco::loop::shared()->call_later([]() {
+    // Timers run on main context
+    assert(!peco::task::this_task().is_alive());
+    later_count += 1;
+    peco::log::debug << "call later fired" << std::endl;
+  }, PECO_TIME_MS(20));
+
+  // a cancelled timer should never be fired
+  auto cancelled_timer = peco::loop::shared()->call_later([]() {
+    assert(0);
+  }, PECO_TIME_MS(10));
+  assert(cancelled_timer.is_alive());
+  cancelled_timer.cancel();
+  assert(!cancelled_timer.is_alive());
+
+  // repeat timer, cancel itself inside the worker
+  peco::timer every_timer;
+  every_timer = peco::loop::shared()->call_every([&every_timer]() {
+    every_count += 1;
+    peco::log::debug << "call every: " << every_count << std::endl;
+    if (every_count == max_every_count) {
+      every_timer.cancel();
+    }
+  }, PECO_TIME_MS(5));
+
+  // Timer can start a normal task
+  peco::loop::shared()->call_later([]() {
+    peco::loop::shared()->run([]() {
+      peco::task::this_task().sleep(PECO_TIME_MS(10));
+      peco::log::debug << "task started by timer" << std::endl;
+    });
+  }, PECO_TIME_MS(1));
+
+  // The loop should exit after all timers done
+  peco::ignore_result(peco::loop::shared()->main());
+  assert(later_count == 1);
+  assert(every_count == max_every_count);
+  assert(!every_timer.is_alive());
+  peco::log::debug << "later_count: " << later_count << ", every_count: " << every_count << std::endl;
+  return 0;
+}
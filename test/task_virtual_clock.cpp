@@ -0,0 +1,97 @@
+/*
+    task_virtual_clock.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+std::vector<peco::duration_t> loop_fires;
+std::vector<peco::duration_t> waiter_wakes;
+int timer_fires = 0;
+
+int main() {
+  bool switched = peco::loop::shared()->set_clock_mode(peco::kClockModeVirtual);
+  assert(switched);
+  peco::ignore_result(switched);
+  assert(peco::loop::shared()->clock_mode() == peco::kClockModeVirtual);
+  auto real_begin = std::chrono::steady_clock::now();
+  auto begin = peco::loop::shared()->now();
+
+  // A keepalive every minute for 3 hours
+  peco::loop::shared()->run_loop([begin]() {
+    loop_fires.push_back(peco::loop::shared()->now() - begin);
+    if (loop_fires.size() == 180) peco::task::this_task().cancel();
+  }, PECO_TIME_S(60));
+
+  // Many waiters which are never waked up
+  for (int i = 1; i <= 100; ++i) {
+    peco::loop::shared()->run([i, begin]() {
+      bool r = peco::task::this_task().holding_until(PECO_TIME_S(30 * i));
+      assert(!r);
+      peco::ignore_result(r);
+      waiter_wakes.push_back(peco::loop::shared()->now() - begin);
+    });
+  }
+
+  // Stackless timer every 10 minutes
+  auto t = peco::loop::shared()->call_every([]() {
+    timer_fires += 1;
+  }, PECO_TIME_S(600));
+  peco::loop::shared()->run_delay([t]() mutable {
+    t.cancel();
+    // Cannot switch the clock of a running loop
+    bool switched = peco::loop::shared()->set_clock_mode(peco::kClockModeReal);
+    assert(!switched);
+    peco::ignore_result(switched);
+  }, PECO_TIME_S(3 * 3600 + 1));
+
+  peco::ignore_result(peco::loop::shared()->main());
+  auto real_cost = std::chrono::steady_clock::now() - real_begin;
+  peco::log::debug << "simulated " << std::chrono::duration_cast<std::chrono::seconds>(
+    peco::loop::shared()->now() - begin).count() << "s in "
+    << std::chrono::duration_cast<std::chrono::milliseconds>(real_cost).count() << "ms" << std::endl;
+
+  // Every time point is exactly where it was scheduled
+  assert(loop_fires.size() == 180);
+  for (size_t i = 0; i < loop_fires.size(); ++i) {
+    assert(loop_fires[i] == PECO_TIME_S(60 * (i + 1)));
+  }
+  assert(waiter_wakes.size() == 100);
+  for (size_t i = 0; i < waiter_wakes.size(); ++i) {
+    assert(waiter_wakes[i] == PECO_TIME_S(30 * (i + 1)));
+  }
+  assert(timer_fires == 18);
+  assert(peco::loop::shared()->now() - begin == PECO_TIME_S(3 * 3600 + 1));
+  assert(real_cost < PECO_TIME_S(5));
+
+  switched = peco::loop::shared()->set_clock_mode(peco::kClockModeReal);
+  assert(switched);
+  assert(peco::loop::shared()->clock_mode() == peco::kClockModeReal);
+  return 0;
+}
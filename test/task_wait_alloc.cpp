@@ -0,0 +1,110 @@
+/*
+    task_wait_alloc.cpp
+    libpeco
+    2026-10-19
+    Push Chen
+*/
+
+/*
+MIT License
+
+Copyright (c) 2019 Push Chen
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "peco.h"
+
+#include <new>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Count all heap allocations of the process
+size_t g_alloc_count = 0;
+
+void* operator new(size_t size) {
+  ++g_alloc_count;
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept {
+  free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+const int kWarmupRounds = 100;
+const int kRounds = 1000;
+
+int main() {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return 1;
+  for (int i = 0; i < 2; ++i) {
+    fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+  }
+
+  size_t alloc_begin = 0, alloc_end = 0;
+  int timedout_count = 0;
+
+  // Echo back everything, wait for both reading and writing
+  peco::loop::shared()->run([&]() {
+    char c;
+    while (true) {
+      peco::task::this_task().wait_fd_for_event(fds[0], peco::kEventTypeRead, PECO_TIME_S(1));
+      if (peco::task::this_task().signal() != peco::kWaitingSignalReceived) break;
+      if (read(fds[0], &c, 1) != 1) break;
+      peco::task::this_task().wait_fd_for_event(fds[0], peco::kEventTypeWrite, PECO_TIME_S(1));
+      if (peco::task::this_task().signal() != peco::kWaitingSignalReceived) break;
+      if (write(fds[0], &c, 1) != 1) break;
+    }
+  });
+
+  peco::loop::shared()->run([&]() {
+    char c = 'p';
+    for (int i = 0; i < kWarmupRounds + kRounds; ++i) {
+      if (i == kWarmupRounds) alloc_begin = g_alloc_count;
+      peco::ignore_result(write(fds[1], &c, 1));
+      peco::task::this_task().wait_fd_for_event(fds[1], peco::kEventTypeRead, PECO_TIME_S(1));
+      assert(peco::task::this_task().signal() == peco::kWaitingSignalReceived);
+      peco::ignore_result(read(fds[1], &c, 1));
+      // Nothing to read, the wait must time out
+      if (i % 100 == 0) {
+        peco::task::this_task().wait_fd_for_event(fds[1], peco::kEventTypeRead, PECO_TIME_MS(1));
+        if (peco::task::this_task().signal() == peco::kWaitingSignalNothing) {
+          ++timedout_count;
+        }
+      }
+    }
+    alloc_end = g_alloc_count;
+    close(fds[1]);
+  });
+
+  peco::ignore_result(peco::loop::shared()->main());
+  close(fds[0]);
+
+  peco::log::debug << "allocations in " << kRounds << " rounds: "
+    << (alloc_end - alloc_begin) << ", timedout: " << timedout_count << std::endl;
+  assert(timedout_count == (kWarmupRounds + kRounds) / 100);
+  assert(alloc_end == alloc_begin);
+  return (alloc_end == alloc_begin ? 0 : 1);
+}